@@ -22,10 +22,10 @@
 
 #import <UIKit/UIKit.h>
 #import "Instruction.h"
-#import "DCPU.h"
+#import "BackgroundEmulator.h"
 #import "Program.h"
 
-@interface ViewController : UIViewController <UITableViewDelegate, UITableViewDataSource>
+@interface ViewController : UIViewController <UITableViewDelegate, UITableViewDataSource, ProgramDelegate>
 
 @property(weak, nonatomic) IBOutlet UILabel *currentInstructionLabel;
 @property(weak, nonatomic) IBOutlet UILabel *currentInstructionOpCode;
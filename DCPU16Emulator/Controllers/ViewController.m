@@ -27,11 +27,13 @@
 @interface ViewController ()
 
 @property(strong, nonatomic) NSArray *possibleNextInput;
-@property(strong, nonatomic) NSDictionary *instructionData;
+@property(strong, nonatomic) Instruction *currentInstruction;
 @property(strong, nonatomic) NSDictionary *mapRegisterNameToControl;
 @property(strong, nonatomic) NSArray *instructionSet;
 @property(strong, nonatomic) Program *program;
-@property(strong, nonatomic) DCPU *emulator;
+@property(strong, nonatomic) BackgroundEmulator *emulator;
+@property(strong, nonatomic) NSTimer *refreshTimer;
+@property(assign, nonatomic) uint32_t displayedSequence;
 
 @end
 
@@ -39,8 +41,10 @@
 
 @synthesize program;
 @synthesize emulator;
+@synthesize refreshTimer;
+@synthesize displayedSequence;
 @synthesize instructionSet;
-@synthesize instructionData;
+@synthesize currentInstruction;
 @synthesize possibleNextInput;
 @synthesize mapRegisterNameToControl;
 
@@ -133,30 +137,51 @@
 {
     NIDPRINTMETHODNAME();
     
-	[self.emulator executeInstruction];
+	[self.emulator step:1];
 }
 
 - (void)resetEmulator
 {
     NIDPRINTMETHODNAME();
     
-	self.emulator = [[DCPU alloc] initWithProgram:(self.program.assembledInstructionSet)];
-    
-	self.emulator.memory.registerDidChange = ^(NSString *registerName, int value)
+	[self.emulator stop];
+	[self.refreshTimer invalidate];
+
+	self.emulator = [[BackgroundEmulator alloc] initWithCPU:[[DCPU alloc] initWithImage:(self.program.assembledImage)]];
+	self.displayedSequence = 0;
+	self.refreshTimer = [NSTimer scheduledTimerWithTimeInterval:1.0 / 30.0
+														 target:self
+													   selector:@selector(refreshRegisterLabels)
+													   userInfo:nil
+														repeats:YES];
+}
+
+// Polls the emulator's published state, the emulation queue never calls back into views.
+- (void)refreshRegisterLabels
+{
+	struct emulator_state state;
+	[self.emulator readState:&state];
+
+	if(state.sequence == self.displayedSequence)
 	{
-		int regIndex = [[self.mapRegisterNameToControl objectForKey:registerName] intValue];
-        
-		UILabel *registerControlToUpdate = ((UILabel *) [self.view viewWithTag:regIndex + 1000]);
-        
-		registerControlToUpdate.text = [NSString stringWithFormat:@"0x%X", value];
-	};
-    
-	self.emulator.memory.generalRegisterDidChange = ^(int regIndex, int value)
+		return;
+	}
+
+	self.displayedSequence = state.sequence;
+
+	int values[3 + NUM_REGISTERS] = {state.programCounter, state.stackPointer, state.overflow};
+
+	for(int reg = 0; reg < NUM_REGISTERS; reg++)
+	{
+		values[3 + reg] = state.registers[reg];
+	}
+
+	for(int i = 0; i < 3 + NUM_REGISTERS; i++)
 	{
-		UILabel *registerControlToUpdate = ((UILabel *) [self.view viewWithTag:regIndex + 1003]);
-        
-		registerControlToUpdate.text = [NSString stringWithFormat:@"0x%X", value];
-	};
+		UILabel *registerControlToUpdate = ((UILabel *) [self.view viewWithTag:i + 1000]);
+
+		registerControlToUpdate.text = [NSString stringWithFormat:@"0x%X", values[i]];
+	}
 }
 
 - (IBAction)assembleButtonPressed
@@ -186,10 +211,10 @@
 {
     NIDPRINTMETHODNAME();
     
-	self.currentInstructionLabel.text = [self.instructionData objectForKey:@"label"];
-	self.currentInstructionOpCode.text = [self.instructionData objectForKey:@"opcode"];
-	self.currentInstructingOperand1.text = [self.instructionData objectForKey:@"operand1"];
-	self.currentInstructingOperand2.text = [self.instructionData objectForKey:@"operand2"];
+	self.currentInstructionLabel.text = self.currentInstruction.label != nil ? self.currentInstruction.label : @"";
+	self.currentInstructionOpCode.text = self.currentInstruction.opcode != nil ? self.currentInstruction.opcode : @"";
+	self.currentInstructingOperand1.text = self.currentInstruction.operand1 != nil ? self.currentInstruction.operand1 : @"";
+	self.currentInstructingOperand2.text = self.currentInstruction.operand2 != nil ? self.currentInstruction.operand2 : @"";
 }
 
 - (void)clearCurrentInstructionBind
@@ -236,31 +261,31 @@
 {
     NIDPRINTMETHODNAME();
     
-	return [[self.instructionData objectForKey:@"state"] intValue];
+	return self.currentInstruction.state;
 }
 
-- (void)editStateChanged:(NSNotification *)notification
+- (void)program:(Program *)sender didChangePossibleNextInput:(NSArray *)possibleInput
 {
     NIDPRINTMETHODNAME();
     
-	self.possibleNextInput = [notification object];
+	self.possibleNextInput = possibleInput;
 	[self setProgramingKeyboardState];
 }
 
-- (void)instructionChanged:(NSNotification *)notification
+- (void)program:(Program *)sender didChangeCurrentInstruction:(Instruction *)instruction
 {
     NIDPRINTMETHODNAME();
     
-	self.instructionData = [notification object];
+	self.currentInstruction = instruction;
 	[self setProgramingKeyboardState];
 	[self bindCurrentInstruction];
 }
 
-- (void)instructionSetChanged:(NSNotification *)notification
+- (void)program:(Program *)sender didChangeInstructionSet:(NSArray *)instructions
 {
     NIDPRINTMETHODNAME();
     
-	self.instructionSet = [notification object];
+	self.instructionSet = instructions;
 	[self.instructionTableView reloadData];
 }
 
@@ -315,13 +340,8 @@
     
 	[super viewDidLoad];
     
-	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
-    
-	[center addObserver:self selector:@selector(editStateChanged:) name:@"EditStateChanged" object:nil];
-	[center addObserver:self selector:@selector(instructionChanged:) name:@"InstructionChanged" object:nil];
-	[center addObserver:self selector:@selector(instructionSetChanged:) name:@"InstructionSetChanged" object:nil];
-    
 	self.program = [[Program alloc] init];
+	self.program.delegate = self;
     
 	[self.instructionTableView reloadData];
     
@@ -346,8 +366,9 @@
 {
     NIDPRINTMETHODNAME();
     
-	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
-	[center removeObserver:self];
+	self.program.delegate = nil;
+	[self.refreshTimer invalidate];
+	[self.emulator stop];
     
 	[self setInstructionButtonCollection:nil];
 	[self setInstructionTableView:nil];
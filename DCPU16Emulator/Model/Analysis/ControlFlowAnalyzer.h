@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#define NO_BLOCK -1
+
+// Block flags, from the instruction that ends the block or from anything inside it.
+#define BLOCK_CONDITIONAL 0x01
+#define BLOCK_JUMPS 0x02
+#define BLOCK_HALTS 0x04
+#define BLOCK_INDIRECT 0x08
+#define BLOCK_CALLS 0x10
+#define BLOCK_WRITES 0x20
+#define BLOCK_TESTS_MEMORY 0x40
+#define BLOCK_LEAVES_IMAGE 0x80
+
+// Loop flags. An infinite loop has no edge out of its body. A busy wait neither writes
+// nor tests memory, so once it goes round once it goes round forever.
+#define LOOP_INFINITE 0x01
+#define LOOP_BUSY_WAIT 0x02
+
+@class Assembler;
+@class SymbolTable;
+
+struct basic_block
+{
+	uint16_t start;
+	uint32_t end;
+	uint32_t instructionCount;
+	uint32_t cycles;
+	int32_t successors[2];
+	// Extra cycles taken on the edge, e.g. a failed test skipping the next instruction.
+	uint8_t penalties[2];
+	uint8_t flags;
+};
+
+struct loop_info
+{
+	int32_t header;
+	int32_t latch;
+	uint32_t blockCount;
+	uint32_t minCycles;
+	uint32_t maxCycles;
+	uint8_t flags;
+};
+
+// Builds the control flow graph of an assembled image with the field layout the
+// InstructionBuilder decodes and the spec cycle costs. Code is found by following
+// jumps, tests and calls from address 0, so data after a jump is not decoded. Every
+// block carries its static cycle cost and every natural loop its per-iteration range.
+@interface ControlFlowAnalyzer : NSObject
+
+@property(nonatomic, readonly) const struct basic_block *blocks;
+@property(nonatomic, readonly) NSUInteger blockCount;
+
+@property(nonatomic, readonly) const struct loop_info *loops;
+@property(nonatomic, readonly) NSUInteger loopCount;
+
+- (void)analyzeImage:(NSData *)image;
+
+- (void)analyzeWords:(const uint16_t *)words count:(NSUInteger)count;
+
+- (void)addLabel:(NSString *)name atAddress:(uint16_t)address;
+
+- (void)addLabelsFromAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols;
+
+- (int)blockAtAddress:(uint16_t)address;
+
+// Nearest label at or before address, e.g. "loop+0x2", or the bare address.
+- (NSString *)symbolizeAddress:(uint16_t)address;
+
+- (NSString *)report;
+
+@end
@@ -0,0 +1,784 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "ControlFlowAnalyzer.h"
+#import "InstructionBuilder.h"
+#import "Statment.h"
+#import "Assembler.h"
+#import "SymbolTable.h"
+#import "CycleCost.h"
+#import "Memory.h"
+
+#define NO_ADDRESS -1
+
+#define INSTRUCTION_START 0x01
+#define LEADER 0x02
+
+#define CODE_POP 0x18
+#define CODE_PUSH 0x1A
+#define CODE_PC 0x1C
+#define CODE_INDIRECT_NEXT_WORD 0x1E
+#define CODE_NEXT_WORD 0x1F
+#define CODE_LITERAL 0x20
+
+#define INITIAL_BLOCK_CAPACITY 64
+
+struct decoded_instruction
+{
+	uint32_t size;
+	uint32_t cycles;
+	int32_t target;
+	uint8_t flags;
+};
+
+@interface ControlFlowAnalyzer ()
+
+@property(nonatomic, strong) NSMutableDictionary *labels;
+@property(nonatomic, strong) NSArray *sortedLabelAddresses;
+
+@end
+
+@implementation ControlFlowAnalyzer
+{
+	const uint16_t *words;
+	NSUInteger wordCount;
+
+	uint8_t *marks;
+	uint32_t *worklist;
+	NSUInteger worklistCount;
+	int32_t *blockOfAddress;
+
+	struct basic_block *blocks;
+	NSUInteger blockCapacity;
+	struct loop_info *loops;
+	NSUInteger loopCapacity;
+}
+
+@synthesize blockCount;
+@synthesize loopCount;
+@synthesize labels;
+@synthesize sortedLabelAddresses;
+
+- (id)init
+{
+	self = [super init];
+
+	self.labels = [[NSMutableDictionary alloc] init];
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(marks);
+	free(worklist);
+	free(blockOfAddress);
+	free(blocks);
+	free(loops);
+}
+
+- (const struct basic_block *)blocks
+{
+	return blocks;
+}
+
+- (const struct loop_info *)loops
+{
+	return loops;
+}
+
+#pragma mark - Decoding
+
+static uint32_t readsNextWord(int code)
+{
+	return (code >= 0x10 && code <= 0x17) || code == CODE_INDIRECT_NEXT_WORD || code == CODE_NEXT_WORD ? 1 : 0;
+}
+
+static BOOL isMemoryOperand(int code)
+{
+	return (code >= 0x08 && code <= CODE_PUSH) || code == CODE_INDIRECT_NEXT_WORD;
+}
+
+static int32_t constantOperand(const uint16_t *words, NSUInteger count, NSUInteger nextWordAddress, int code)
+{
+	if(code >= CODE_LITERAL)
+	{
+		return code - CODE_LITERAL;
+	}
+
+	if(code == CODE_NEXT_WORD && nextWordAddress < count)
+	{
+		return words[nextWordAddress];
+	}
+
+	return NO_ADDRESS;
+}
+
+static struct decoded_instruction decode(const uint16_t *words, NSUInteger count, NSUInteger address)
+{
+	struct decoded_instruction decoded = {1, 0, NO_ADDRESS, 0};
+	uint16_t word = words[address];
+	int opcode = word & OpMask;
+	int a = (word >> OperandAShift) & OperandAMask;
+	int b = (word >> OperandBShift) & OperandBMask;
+
+	if(opcode == 0)
+	{
+		if(a != OP_JSR)
+		{
+			// The emulator stops on a word it can not build an instruction from.
+			decoded.flags = BLOCK_HALTS;
+			return decoded;
+		}
+
+		decoded.size += readsNextWord(b);
+		decoded.cycles = (uint32_t) (cyclesForNonBasicOpcode(a) + cyclesForOperandCode(b));
+		decoded.target = constantOperand(words, count, address + 1, b);
+		decoded.flags = BLOCK_CALLS | BLOCK_WRITES;
+		return decoded;
+	}
+
+	NSUInteger bNextWord = address + 1 + readsNextWord(a);
+	decoded.size += readsNextWord(a) + readsNextWord(b);
+	decoded.cycles = (uint32_t) (cyclesForBasicOpcode(opcode) + cyclesForOperandCode(a) + cyclesForOperandCode(b));
+
+	if(opcode >= OP_IFE)
+	{
+		decoded.flags = BLOCK_CONDITIONAL;
+
+		if(isMemoryOperand(a) || isMemoryOperand(b))
+		{
+			decoded.flags |= BLOCK_TESTS_MEMORY;
+		}
+	}
+	else if(a == CODE_PC)
+	{
+		decoded.target = opcode == OP_SET ? constantOperand(words, count, bNextWord, b) : NO_ADDRESS;
+		decoded.flags = decoded.target != NO_ADDRESS ? BLOCK_JUMPS : BLOCK_INDIRECT;
+	}
+	else
+	{
+		decoded.flags = BLOCK_WRITES;
+	}
+
+	if(a == CODE_POP || a == CODE_PUSH || b == CODE_POP || b == CODE_PUSH)
+	{
+		decoded.flags |= BLOCK_WRITES;
+	}
+
+	return decoded;
+}
+
+#pragma mark - Analysis
+
+- (void)analyzeImage:(NSData *)image
+{
+	[self analyzeWords:[image bytes] count:[image length] / sizeof(uint16_t)];
+}
+
+- (void)analyzeWords:(const uint16_t *)theWords count:(NSUInteger)count
+{
+	words = theWords;
+	wordCount = MIN(count, (NSUInteger) MEMORY_SIZE);
+	blockCount = 0;
+	loopCount = 0;
+
+	free(marks);
+	free(worklist);
+	free(blockOfAddress);
+	marks = calloc(MAX(wordCount, 1), sizeof(uint8_t));
+	worklist = malloc(MAX(wordCount, 1) * sizeof(uint32_t));
+	blockOfAddress = malloc(MAX(wordCount, 1) * sizeof(int32_t));
+
+	[self findReachableInstructions];
+	[self buildBlocks];
+	[self findLoops];
+
+	words = NULL;
+}
+
+- (void)markAddress:(int64_t)address asLeader:(BOOL)leader
+{
+	if(address < 0 || (NSUInteger) address >= wordCount)
+	{
+		return;
+	}
+
+	if(leader)
+	{
+		marks[address] |= LEADER;
+	}
+
+	if(!(marks[address] & INSTRUCTION_START))
+	{
+		marks[address] |= INSTRUCTION_START;
+		worklist[worklistCount++] = (uint32_t) address;
+	}
+}
+
+// Tests lead to the next instruction and to the one after it, which a failed test
+// skips; jumps and calls lead to their target when it is a constant.
+- (void)findReachableInstructions
+{
+	worklistCount = 0;
+	[self markAddress:0 asLeader:YES];
+
+	while(worklistCount > 0)
+	{
+		NSUInteger address = worklist[--worklistCount];
+		struct decoded_instruction instruction = decode(words, wordCount, address);
+		NSUInteger next = address + instruction.size;
+
+		if(instruction.flags & BLOCK_CONDITIONAL)
+		{
+			[self markAddress:(int64_t) next asLeader:YES];
+
+			if(next < wordCount)
+			{
+				[self markAddress:(int64_t) (next + decode(words, wordCount, next).size) asLeader:YES];
+			}
+		}
+		else if(instruction.flags & BLOCK_JUMPS)
+		{
+			[self markAddress:instruction.target asLeader:YES];
+		}
+		else if(!(instruction.flags & (BLOCK_HALTS | BLOCK_INDIRECT)))
+		{
+			[self markAddress:(int64_t) next asLeader:NO];
+
+			if(instruction.flags & BLOCK_CALLS)
+			{
+				[self markAddress:instruction.target asLeader:YES];
+			}
+		}
+	}
+}
+
+- (struct basic_block *)openBlockAtAddress:(NSUInteger)address
+{
+	if(blockCount == blockCapacity)
+	{
+		blockCapacity = blockCapacity == 0 ? INITIAL_BLOCK_CAPACITY : blockCapacity * 2;
+		blocks = realloc(blocks, blockCapacity * sizeof(struct basic_block));
+	}
+
+	struct basic_block *block = &blocks[blockCount];
+	memset(block, 0, sizeof(struct basic_block));
+	block->start = (uint16_t) address;
+	block->successors[0] = NO_ADDRESS;
+	block->successors[1] = NO_ADDRESS;
+
+	blockOfAddress[address] = (int32_t) blockCount;
+	blockCount++;
+
+	return block;
+}
+
+// Successors hold addresses until every block exists, then become block indices.
+- (void)buildBlocks
+{
+	struct basic_block *block = NULL;
+	int64_t fallsTo = NO_ADDRESS;
+
+	for(NSUInteger address = 0; address < wordCount; address++)
+	{
+		blockOfAddress[address] = NO_BLOCK;
+	}
+
+	for(NSUInteger address = 0; address < wordCount; address++)
+	{
+		if(!(marks[address] & INSTRUCTION_START))
+		{
+			continue;
+		}
+
+		if(block != NULL && ((marks[address] & LEADER) || fallsTo != (int64_t) address))
+		{
+			block->successors[0] = (int32_t) fallsTo;
+			block = NULL;
+		}
+
+		if(block == NULL)
+		{
+			block = [self openBlockAtAddress:address];
+		}
+
+		struct decoded_instruction instruction = decode(words, wordCount, address);
+		NSUInteger next = address + instruction.size;
+
+		block->end = (uint32_t) next;
+		block->instructionCount++;
+		block->cycles += instruction.cycles;
+		block->flags |= instruction.flags;
+		fallsTo = (int64_t) next;
+
+		if(instruction.flags & BLOCK_CONDITIONAL)
+		{
+			block->successors[0] = (int32_t) next;
+			block->successors[1] = (int32_t) (next < wordCount ? next + decode(words, wordCount, next).size : next + 1);
+			block->penalties[1] = FAILED_TEST_CYCLES;
+			block = NULL;
+		}
+		else if(instruction.flags & (BLOCK_JUMPS | BLOCK_HALTS | BLOCK_INDIRECT))
+		{
+			block->successors[0] = instruction.target;
+			block = NULL;
+		}
+		else if((instruction.flags & BLOCK_CALLS) && instruction.target == NO_ADDRESS)
+		{
+			// Nothing is known about what an unknown callee does before it returns.
+			block->successors[0] = (int32_t) next;
+			block = NULL;
+		}
+	}
+
+	if(block != NULL)
+	{
+		block->successors[0] = (int32_t) fallsTo;
+	}
+
+	for(NSUInteger index = 0; index < blockCount; index++)
+	{
+		for(int edge = 0; edge < 2; edge++)
+		{
+			int32_t address = blocks[index].successors[edge];
+
+			if(address == NO_ADDRESS)
+			{
+				continue;
+			}
+
+			int32_t successor = (NSUInteger) address < wordCount ? blockOfAddress[address] : NO_BLOCK;
+
+			if(successor == NO_BLOCK)
+			{
+				blocks[index].flags |= BLOCK_LEAVES_IMAGE;
+			}
+
+			blocks[index].successors[edge] = successor;
+		}
+	}
+}
+
+static int compareKeys(const void *left, const void *right)
+{
+	uint64_t a = *(const uint64_t *) left;
+	uint64_t b = *(const uint64_t *) right;
+
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+// Depth first search marks retreating edges and numbers blocks in reverse postorder,
+// which is a topological order once those edges are ignored. Every block with
+// retreating edges into it heads a natural loop made of the blocks that reach one
+// of its latches without passing through it.
+- (void)findLoops
+{
+	NSUInteger count = MAX(blockCount, 1);
+	uint8_t *state = calloc(count, sizeof(uint8_t));
+	uint8_t *nextEdge = calloc(count, sizeof(uint8_t));
+	uint8_t *backEdges = calloc(count, sizeof(uint8_t));
+	uint32_t *rpo = malloc(count * sizeof(uint32_t));
+	// Also the worklist of loop bodies, which pushes once per edge at most.
+	int32_t *stack = malloc(count * 2 * sizeof(int32_t));
+	NSUInteger postCount = 0;
+
+	for(NSUInteger root = 0; root < blockCount; root++)
+	{
+		if(state[root] != 0)
+		{
+			continue;
+		}
+
+		NSUInteger depth = 0;
+		stack[depth++] = (int32_t) root;
+		state[root] = 1;
+
+		while(depth > 0)
+		{
+			int32_t block = stack[depth - 1];
+
+			if(nextEdge[block] < 2)
+			{
+				int edge = nextEdge[block]++;
+				int32_t successor = blocks[block].successors[edge];
+
+				if(successor == NO_BLOCK)
+				{
+					continue;
+				}
+
+				if(state[successor] == 0)
+				{
+					state[successor] = 1;
+					stack[depth++] = successor;
+				}
+				else if(state[successor] == 1)
+				{
+					backEdges[block] |= (uint8_t) (1 << edge);
+				}
+			}
+			else
+			{
+				state[block] = 2;
+				rpo[block] = (uint32_t) (blockCount - 1 - postCount++);
+				depth--;
+			}
+		}
+	}
+
+	// Predecessors in compressed rows.
+	uint32_t *predecessorStart = calloc(count + 1, sizeof(uint32_t));
+	uint32_t *predecessors = malloc(count * 2 * sizeof(uint32_t));
+
+	for(NSUInteger block = 0; block < blockCount; block++)
+	{
+		for(int edge = 0; edge < 2; edge++)
+		{
+			if(blocks[block].successors[edge] != NO_BLOCK)
+			{
+				predecessorStart[blocks[block].successors[edge] + 1]++;
+			}
+		}
+	}
+
+	for(NSUInteger block = 0; block < blockCount; block++)
+	{
+		predecessorStart[block + 1] += predecessorStart[block];
+	}
+
+	uint32_t *fill = malloc(count * sizeof(uint32_t));
+	memcpy(fill, predecessorStart, count * sizeof(uint32_t));
+
+	for(NSUInteger block = 0; block < blockCount; block++)
+	{
+		for(int edge = 0; edge < 2; edge++)
+		{
+			int32_t successor = blocks[block].successors[edge];
+
+			if(successor != NO_BLOCK)
+			{
+				predecessors[fill[successor]++] = (uint32_t) block;
+			}
+		}
+	}
+
+	uint32_t *loopStamp = calloc(count, sizeof(uint32_t));
+	uint64_t *body = malloc(count * sizeof(uint64_t));
+	int64_t *minCycles = malloc(count * sizeof(int64_t));
+	int64_t *maxCycles = malloc(count * sizeof(int64_t));
+
+	for(NSUInteger header = 0; header < blockCount; header++)
+	{
+		uint32_t stamp = (uint32_t) header + 1;
+		NSUInteger bodyCount = 0;
+		NSUInteger depth = 0;
+		int32_t firstLatch = NO_BLOCK;
+
+		for(uint32_t p = predecessorStart[header]; p < predecessorStart[header + 1]; p++)
+		{
+			uint32_t latch = predecessors[p];
+
+			for(int edge = 0; edge < 2; edge++)
+			{
+				if((backEdges[latch] & (1 << edge)) && blocks[latch].successors[edge] == (int32_t) header && firstLatch == NO_BLOCK)
+				{
+					firstLatch = (int32_t) latch;
+				}
+			}
+		}
+
+		if(firstLatch == NO_BLOCK)
+		{
+			continue;
+		}
+
+		loopStamp[header] = stamp;
+		body[bodyCount++] = ((uint64_t) rpo[header] << 32) | header;
+
+		for(uint32_t p = predecessorStart[header]; p < predecessorStart[header + 1]; p++)
+		{
+			uint32_t latch = predecessors[p];
+
+			if((backEdges[latch] & 1 && blocks[latch].successors[0] == (int32_t) header) ||
+					(backEdges[latch] & 2 && blocks[latch].successors[1] == (int32_t) header))
+			{
+				stack[depth++] = (int32_t) latch;
+			}
+		}
+
+		while(depth > 0)
+		{
+			int32_t block = stack[--depth];
+
+			if(loopStamp[block] == stamp)
+			{
+				continue;
+			}
+
+			loopStamp[block] = stamp;
+			body[bodyCount++] = ((uint64_t) rpo[block] << 32) | (uint32_t) block;
+
+			for(uint32_t p = predecessorStart[block]; p < predecessorStart[block + 1]; p++)
+			{
+				if(loopStamp[predecessors[p]] != stamp)
+				{
+					stack[depth++] = (int32_t) predecessors[p];
+				}
+			}
+		}
+
+		qsort(body, bodyCount, sizeof(uint64_t), compareKeys);
+
+		[self addLoopWithHeader:(int32_t) header
+						  latch:firstLatch
+						   body:body
+						  count:bodyCount
+						  stamp:stamp
+					  loopStamp:loopStamp
+					  backEdges:backEdges
+					  minCycles:minCycles
+					  maxCycles:maxCycles];
+	}
+
+	free(state);
+	free(nextEdge);
+	free(backEdges);
+	free(rpo);
+	free(stack);
+	free(predecessorStart);
+	free(predecessors);
+	free(fill);
+	free(loopStamp);
+	free(body);
+	free(minCycles);
+	free(maxCycles);
+}
+
+// Longest and shortest header to latch paths over the loop's forward edges.
+- (void)addLoopWithHeader:(int32_t)header
+					latch:(int32_t)latch
+					 body:(const uint64_t *)body
+					count:(NSUInteger)bodyCount
+					stamp:(uint32_t)stamp
+				loopStamp:(const uint32_t *)loopStamp
+				backEdges:(const uint8_t *)backEdges
+				minCycles:(int64_t *)minCycles
+				maxCycles:(int64_t *)maxCycles
+{
+	uint8_t flags = 0;
+	BOOL exits = NO;
+	int64_t iterationMin = -1;
+	int64_t iterationMax = -1;
+
+	for(NSUInteger i = 0; i < bodyCount; i++)
+	{
+		uint32_t block = (uint32_t) body[i];
+		minCycles[block] = -1;
+		maxCycles[block] = -1;
+		flags |= blocks[block].flags;
+	}
+
+	minCycles[header] = blocks[header].cycles;
+	maxCycles[header] = blocks[header].cycles;
+
+	for(NSUInteger i = 0; i < bodyCount; i++)
+	{
+		uint32_t block = (uint32_t) body[i];
+
+		for(int edge = 0; edge < 2; edge++)
+		{
+			int32_t successor = blocks[block].successors[edge];
+
+			if(successor == NO_BLOCK)
+			{
+				continue;
+			}
+
+			if(loopStamp[successor] != stamp)
+			{
+				exits = YES;
+				continue;
+			}
+
+			if(minCycles[block] < 0)
+			{
+				continue;
+			}
+
+			int64_t cost = blocks[block].penalties[edge];
+
+			if(backEdges[block] & (1 << edge))
+			{
+				if(successor == header)
+				{
+					iterationMin = iterationMin < 0 ? minCycles[block] + cost : MIN(iterationMin, minCycles[block] + cost);
+					iterationMax = MAX(iterationMax, maxCycles[block] + cost);
+				}
+
+				continue;
+			}
+
+			cost += blocks[successor].cycles;
+			minCycles[successor] = minCycles[successor] < 0 ? minCycles[block] + cost : MIN(minCycles[successor], minCycles[block] + cost);
+			maxCycles[successor] = MAX(maxCycles[successor], maxCycles[block] + cost);
+		}
+	}
+
+	if(loopCount == loopCapacity)
+	{
+		loopCapacity = loopCapacity == 0 ? INITIAL_BLOCK_CAPACITY : loopCapacity * 2;
+		loops = realloc(loops, loopCapacity * sizeof(struct loop_info));
+	}
+
+	struct loop_info *loop = &loops[loopCount++];
+	loop->header = header;
+	loop->latch = latch;
+	loop->blockCount = (uint32_t) bodyCount;
+	loop->minCycles = (uint32_t) MAX(iterationMin, 0);
+	loop->maxCycles = (uint32_t) MAX(iterationMax, 0);
+	loop->flags = 0;
+
+	if(!exits && !(flags & (BLOCK_HALTS | BLOCK_INDIRECT | BLOCK_CALLS | BLOCK_LEAVES_IMAGE)))
+	{
+		loop->flags |= LOOP_INFINITE;
+	}
+
+	if(!(flags & (BLOCK_WRITES | BLOCK_TESTS_MEMORY | BLOCK_HALTS | BLOCK_INDIRECT | BLOCK_CALLS)))
+	{
+		loop->flags |= LOOP_BUSY_WAIT;
+	}
+}
+
+- (int)blockAtAddress:(uint16_t)address
+{
+	for(NSUInteger index = 0; index < blockCount; index++)
+	{
+		if(address >= blocks[index].start && address < blocks[index].end)
+		{
+			return (int) index;
+		}
+	}
+
+	return NO_BLOCK;
+}
+
+#pragma mark - Symbolization
+
+- (void)addLabel:(NSString *)name atAddress:(uint16_t)address
+{
+	[self.labels setObject:name forKey:[NSNumber numberWithUnsignedShort:address]];
+	self.sortedLabelAddresses = nil;
+}
+
+- (void)addLabelsFromAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols
+{
+	for(NSUInteger symbol = 0; symbol < symbols.count; symbol++)
+	{
+		int address = [assembler addressOfSymbol:(int) symbol];
+
+		if(address != UNDEFINED_LABEL)
+		{
+			[self addLabel:[symbols nameForSymbol:(int) symbol] atAddress:(uint16_t) address];
+		}
+	}
+}
+
+- (NSString *)symbolizeAddress:(uint16_t)address
+{
+	if(self.sortedLabelAddresses == nil)
+	{
+		self.sortedLabelAddresses = [[self.labels allKeys] sortedArrayUsingSelector:@selector(compare:)];
+	}
+
+	NSUInteger low = 0;
+	NSUInteger high = [self.sortedLabelAddresses count];
+
+	while(low < high)
+	{
+		NSUInteger middle = (low + high) / 2;
+
+		if([[self.sortedLabelAddresses objectAtIndex:middle] unsignedShortValue] <= address)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if(low == 0)
+	{
+		return [NSString stringWithFormat:@"0x%04X", address];
+	}
+
+	NSNumber *labelAddress = [self.sortedLabelAddresses objectAtIndex:low - 1];
+	NSString *name = [self.labels objectForKey:labelAddress];
+	uint16_t offset = (uint16_t) (address - [labelAddress unsignedShortValue]);
+
+	return offset == 0 ? name : [NSString stringWithFormat:@"%@+0x%X", name, offset];
+}
+
+- (NSString *)report
+{
+	NSMutableString *report = [NSMutableString string];
+
+	for(NSUInteger index = 0; index < blockCount; index++)
+	{
+		struct basic_block *block = &blocks[index];
+
+		[report appendFormat:@"block %@ [0x%04X, 0x%04X): %u instructions, %u cycles",
+							 [self symbolizeAddress:block->start],
+							 block->start,
+							 block->end,
+							 block->instructionCount,
+							 block->cycles];
+
+		for(int edge = 0; edge < 2; edge++)
+		{
+			if(block->successors[edge] != NO_BLOCK)
+			{
+				[report appendFormat:@" -> %@", [self symbolizeAddress:blocks[block->successors[edge]].start]];
+			}
+		}
+
+		[report appendString:@"\n"];
+	}
+
+	for(NSUInteger index = 0; index < loopCount; index++)
+	{
+		struct loop_info *loop = &loops[index];
+
+		[report appendFormat:@"loop %@: %u blocks, %u-%u cycles per iteration%@%@\n",
+							 [self symbolizeAddress:blocks[loop->header].start],
+							 loop->blockCount,
+							 loop->minCycles,
+							 loop->maxCycles,
+							 loop->flags & LOOP_INFINITE ? @", infinite" : @"",
+							 loop->flags & LOOP_BUSY_WAIT ? @", busy wait" : @""];
+	}
+
+	return report;
+}
+
+@end
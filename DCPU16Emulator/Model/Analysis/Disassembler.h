@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+// Longest line disassembleWords: writes, including the terminating NUL.
+#define DISASSEMBLY_LINE_LENGTH 96
+
+// Renders machine code as assembler source from fixed mnemonic and 64 entry operand
+// tables, writing into a caller supplied buffer without allocating. The text assembles
+// back to the same words: encodings the Assembler would shorten, such as a next word
+// literal below 0x20, and words that are not instructions come out as DAT with the
+// instruction in a comment.
+@interface Disassembler : NSObject
+
+// Writes the instruction at address as NUL terminated text, truncated to length, and
+// returns the number of words it spans, or 0 past the end of the words.
+- (NSUInteger)disassembleWords:(const uint16_t *)words
+						 count:(NSUInteger)count
+					 atAddress:(NSUInteger)address
+					intoBuffer:(char *)buffer
+						length:(NSUInteger)length;
+
+// One line per instruction, ready for the Lexer and Parser.
+- (NSString *)sourceOfImage:(NSData *)image;
+
+@end
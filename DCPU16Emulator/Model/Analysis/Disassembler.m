@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "Disassembler.h"
+#import "InstructionBuilder.h"
+#import "Statment.h"
+
+struct operand_form
+{
+	const char *prefix;
+	const char *suffix;
+	uint8_t nextWord;
+};
+
+static const char *const basicMnemonics[16] = {
+	"DAT", "SET", "ADD", "SUB", "MUL", "DIV", "MOD", "SHL",
+	"SHR", "AND", "BOR", "XOR", "IFE", "IFN", "IFG", "IFB"
+};
+
+// Indexed by the 6 bit operand code; next word forms print the word between prefix and suffix.
+static const struct operand_form operandForms[64] = {
+	{"A", "", 0}, {"B", "", 0}, {"C", "", 0}, {"X", "", 0},
+	{"Y", "", 0}, {"Z", "", 0}, {"I", "", 0}, {"J", "", 0},
+	{"[A]", "", 0}, {"[B]", "", 0}, {"[C]", "", 0}, {"[X]", "", 0},
+	{"[Y]", "", 0}, {"[Z]", "", 0}, {"[I]", "", 0}, {"[J]", "", 0},
+	{"[", "+A]", 1}, {"[", "+B]", 1}, {"[", "+C]", 1}, {"[", "+X]", 1},
+	{"[", "+Y]", 1}, {"[", "+Z]", 1}, {"[", "+I]", 1}, {"[", "+J]", 1},
+	{"POP", "", 0}, {"PEEK", "", 0}, {"PUSH", "", 0}, {"SP", "", 0},
+	{"PC", "", 0}, {"O", "", 0}, {"[", "]", 1}, {"", "", 1},
+	{"0x00", "", 0}, {"0x01", "", 0}, {"0x02", "", 0}, {"0x03", "", 0},
+	{"0x04", "", 0}, {"0x05", "", 0}, {"0x06", "", 0}, {"0x07", "", 0},
+	{"0x08", "", 0}, {"0x09", "", 0}, {"0x0A", "", 0}, {"0x0B", "", 0},
+	{"0x0C", "", 0}, {"0x0D", "", 0}, {"0x0E", "", 0}, {"0x0F", "", 0},
+	{"0x10", "", 0}, {"0x11", "", 0}, {"0x12", "", 0}, {"0x13", "", 0},
+	{"0x14", "", 0}, {"0x15", "", 0}, {"0x16", "", 0}, {"0x17", "", 0},
+	{"0x18", "", 0}, {"0x19", "", 0}, {"0x1A", "", 0}, {"0x1B", "", 0},
+	{"0x1C", "", 0}, {"0x1D", "", 0}, {"0x1E", "", 0}, {"0x1F", "", 0},
+};
+
+static const char hexDigits[16] = "0123456789ABCDEF";
+
+struct text_writer
+{
+	char *buffer;
+	NSUInteger length;
+	NSUInteger position;
+};
+
+static void appendText(struct text_writer *writer, const char *text)
+{
+	while(*text != '\0' && writer->position + 1 < writer->length)
+	{
+		writer->buffer[writer->position++] = *text++;
+	}
+}
+
+static void appendHex(struct text_writer *writer, uint16_t value)
+{
+	char text[7] = {'0', 'x',
+			hexDigits[(value >> 12) & 0xF], hexDigits[(value >> 8) & 0xF],
+			hexDigits[(value >> 4) & 0xF], hexDigits[value & 0xF], '\0'};
+
+	appendText(writer, text);
+}
+
+static void appendOperand(struct text_writer *writer, int code, const uint16_t *nextWord)
+{
+	const struct operand_form *form = &operandForms[code];
+
+	appendText(writer, form->prefix);
+
+	if(form->nextWord)
+	{
+		appendHex(writer, *nextWord);
+	}
+
+	appendText(writer, form->suffix);
+}
+
+static void appendData(struct text_writer *writer, const uint16_t *words, NSUInteger count)
+{
+	appendText(writer, "DAT ");
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		if(i > 0)
+		{
+			appendText(writer, ", ");
+		}
+
+		appendHex(writer, words[i]);
+	}
+}
+
+@implementation Disassembler
+
+- (NSUInteger)disassembleWords:(const uint16_t *)words
+						 count:(NSUInteger)count
+					 atAddress:(NSUInteger)address
+					intoBuffer:(char *)buffer
+						length:(NSUInteger)length
+{
+	struct text_writer writer = {buffer, length, 0};
+
+	if(length == 0)
+	{
+		return 0;
+	}
+
+	buffer[0] = '\0';
+
+	if(address >= count)
+	{
+		return 0;
+	}
+
+	const uint16_t *instruction = words + address;
+	int opcode = instruction[0] & OpMask;
+	int a = (instruction[0] >> OperandAShift) & OperandAMask;
+	int b = (instruction[0] >> OperandBShift) & OperandBMask;
+	BOOL basic = opcode != 0;
+
+	if(!basic && a != OP_JSR)
+	{
+		appendData(&writer, instruction, 1);
+		buffer[writer.position] = '\0';
+		return 1;
+	}
+
+	const uint16_t *aNextWord = instruction + 1;
+	const uint16_t *bNextWord = basic ? aNextWord + operandForms[a].nextWord : aNextWord;
+	NSUInteger size = (NSUInteger) (bNextWord - instruction) + operandForms[b].nextWord;
+
+	if(address + size > count)
+	{
+		appendData(&writer, instruction, 1);
+		buffer[writer.position] = '\0';
+		return 1;
+	}
+
+	BOOL shortens = (basic && operandForms[a].nextWord && *aNextWord <= OPERAND_LITERAL_MAX) ||
+			(operandForms[b].nextWord && *bNextWord <= OPERAND_LITERAL_MAX);
+
+	if(shortens)
+	{
+		appendData(&writer, instruction, size);
+		appendText(&writer, " ; ");
+	}
+
+	if(basic)
+	{
+		appendText(&writer, basicMnemonics[opcode]);
+		appendText(&writer, " ");
+		appendOperand(&writer, a, aNextWord);
+		appendText(&writer, ", ");
+	}
+	else
+	{
+		appendText(&writer, "JSR ");
+	}
+
+	appendOperand(&writer, b, bNextWord);
+	buffer[writer.position] = '\0';
+
+	return size;
+}
+
+- (NSString *)sourceOfImage:(NSData *)image
+{
+	const uint16_t *words = [image bytes];
+	NSUInteger count = [image length] / sizeof(uint16_t);
+	NSMutableString *source = [NSMutableString stringWithCapacity:count * 16];
+	char line[DISASSEMBLY_LINE_LENGTH];
+	NSUInteger address = 0;
+
+	while(address < count)
+	{
+		address += [self disassembleWords:words count:count atAddress:address intoBuffer:line length:sizeof(line)];
+
+		if([source length] > 0)
+		{
+			[source appendString:@"\n"];
+		}
+
+		[source appendFormat:@"%s", line];
+	}
+
+	return source;
+}
+
+@end
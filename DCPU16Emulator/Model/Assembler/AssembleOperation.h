@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "NIOperations.h"
+
+@class CachedAssembly;
+
+extern NSString *const AssembleOperationErrorDomain;
+
+// Lexes, parses and assembles one source on an operation queue. Cancellation is checked
+// between statments and before encoding; a cancelled operation reports nothing.
+@interface AssembleOperation : NIOperation
+
+@property(nonatomic, copy, readonly) NSString *source;
+@property(nonatomic, copy, readonly) NSString *key;
+@property(nonatomic, assign) BOOL relaxLabelReferences;
+@property(nonatomic, copy) NSString *includeDirectory;
+
+@property(nonatomic, strong, readonly) CachedAssembly *result;
+@property(nonatomic, copy, readonly) NSString *errorMessage;
+
+- (id)initWithSource:(NSString *)source key:(NSString *)key;
+
+@end
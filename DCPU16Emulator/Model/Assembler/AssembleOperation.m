@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssembleOperation.h"
+#import "NIOperations+Subclassing.h"
+#import "CachedAssembly.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "StatmentTable.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+
+NSString *const AssembleOperationErrorDomain = @"AssembleOperationErrorDomain";
+
+@interface AssembleOperation ()
+
+@property(nonatomic, copy, readwrite) NSString *source;
+@property(nonatomic, copy, readwrite) NSString *key;
+@property(nonatomic, strong, readwrite) CachedAssembly *result;
+@property(nonatomic, copy, readwrite) NSString *errorMessage;
+
+@end
+
+@implementation AssembleOperation
+
+@synthesize source;
+@synthesize key;
+@synthesize relaxLabelReferences;
+@synthesize includeDirectory;
+@synthesize result;
+@synthesize errorMessage;
+
+- (id)initWithSource:(NSString *)theSource key:(NSString *)theKey
+{
+	self = [super init];
+
+	self.source = theSource;
+	self.key = theKey;
+
+	return self;
+}
+
+- (void)main
+{
+	@autoreleasepool
+	{
+		if([self isCancelled])
+		{
+			return;
+		}
+
+		[self didStart];
+
+		@try
+		{
+			CachedAssembly *assembly = [self assemble];
+
+			if(assembly == nil)
+			{
+				return;
+			}
+
+			self.result = assembly;
+
+			[self willFinish];
+			[self didFinish];
+		}
+		@catch(NSString *message)
+		{
+			self.errorMessage = message;
+
+			[self didFailWithError:[NSError errorWithDomain:AssembleOperationErrorDomain
+													   code:0
+												   userInfo:[NSDictionary dictionaryWithObject:message forKey:NSLocalizedDescriptionKey]]];
+		}
+	}
+}
+
+- (CachedAssembly *)assemble
+{
+	__weak AssembleOperation *operation = self;
+
+	Parser *parser = [[Parser alloc] init];
+	parser.includeDirectory = self.includeDirectory;
+	parser.shouldCancel = ^BOOL
+	{
+		return [operation isCancelled];
+	};
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+										 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	StatmentTable *table = [[StatmentTable alloc] init];
+	[parser parseSource:self.source withLexer:lexer intoTable:table];
+
+	if(parser.wasCancelled || [self isCancelled])
+	{
+		return nil;
+	}
+
+	Assembler *assembler = [[Assembler alloc] init];
+	assembler.relaxLabelReferences = self.relaxLabelReferences;
+	[assembler assembleStatmentTable:table];
+
+	return [[CachedAssembly alloc] initWithAssembler:assembler symbols:table.symbols];
+}
+
+@end
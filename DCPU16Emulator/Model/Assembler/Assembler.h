@@ -20,10 +20,57 @@
  * SOFTWARE.
  */
 
+#import "PipelineStats.h"
+
+@class StatmentTable;
+
+#define UNDEFINED_LABEL -1
+#define DEFAULT_ROWS_PER_CHUNK 4096
+
+struct label_fixup
+{
+	uint32_t offset;
+	int32_t symbol;
+};
+
 @interface Assembler : NSObject
 
+// Assembled words in host byte order, valid until the next assemble call.
+@property(nonatomic, readonly) const uint16_t *words;
+@property(nonatomic, readonly) NSUInteger wordCount;
+
+// Boxed copy of words, built on first access for callers that want an array.
 @property(nonatomic, strong, readonly) NSMutableArray *program;
 
+// Encode label operands that end up below 0x20 as short literals, re-laying out
+// the program until no further operand can shrink. Off by default.
+@property(nonatomic, assign) BOOL relaxLabelReferences;
+
+// Number of label operands encoded as short literals by the last assemble call.
+@property(nonatomic, readonly) NSUInteger relaxedReferenceCount;
+
+// Word offset of every label operand and the symbol it refers to.
+@property(nonatomic, readonly) const struct label_fixup *fixups;
+@property(nonatomic, readonly) NSUInteger fixupCount;
+
+// Rows sized and encoded per task; tables of at most one chunk encode on the calling thread.
+@property(nonatomic, assign) NSUInteger rowsPerChunk;
+
+// Word offset at which each statment row starts.
+@property(nonatomic, readonly) const uint32_t *rowOffsets;
+
+// Accumulates over assemble calls until reset.
+@property(nonatomic, readonly) struct pipeline_stats stats;
+
+- (void)resetStats;
+
 - (void)assembleStatments:(NSArray *)statments;
 
+- (void)assembleStatmentTable:(StatmentTable *)table;
+
+- (NSData *)image;
+
+// Word address a symbol of the last assembled table was defined at, or UNDEFINED_LABEL.
+- (int)addressOfSymbol:(int)symbol;
+
 @end
@@ -21,67 +21,468 @@
  */
 
 #import "Assembler.h"
-#import "Statment.h"
-#import "NullOperand.h"
-#import "NextWordOperand.h"
-#import "IndirectNextWordOperand.h"
-#import "IndirectNextWordOffsetOperand.h"
+#import "StatmentTable.h"
+
+#define INITIAL_WORD_CAPACITY 256
+#define INITIAL_FIXUP_CAPACITY 32
+
+struct encode_cursor
+{
+	NSUInteger word;
+	NSUInteger fixup;
+};
 
 @interface Assembler ()
+{
+	int *labelDef;
+	uint16_t *buffer;
+	NSUInteger wordCapacity;
+	struct label_fixup *fixups;
+	NSUInteger fixupCount;
+	NSUInteger fixupCapacity;
+	uint8_t *relaxed[2];
+	uint32_t *rowOffsetColumn;
+	uint32_t *fixupOffsetColumn;
+	dispatch_queue_t q_default;
+}
 
 @property(nonatomic, strong, readwrite) NSMutableArray *program;
-@property(nonatomic, strong) NSMutableDictionary *labelDef;
-@property(nonatomic, strong) NSMutableDictionary *labelRef;
+@property(nonatomic, strong) StatmentTable *table;
 
 @end
 
 @implementation Assembler
 
-@synthesize labelDef;
-@synthesize labelRef;
+@synthesize wordCount;
 @synthesize program;
+@synthesize table;
+@synthesize relaxLabelReferences;
+@synthesize relaxedReferenceCount;
+@synthesize fixupCount;
+@synthesize rowsPerChunk;
+@synthesize stats;
+
+- (id)init
+{
+	self = [super init];
+
+	self.rowsPerChunk = DEFAULT_ROWS_PER_CHUNK;
+	q_default = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(labelDef);
+	free(buffer);
+	free(fixups);
+	free(relaxed[FIRST_OPERAND]);
+	free(relaxed[SECOND_OPERAND]);
+	free(rowOffsetColumn);
+	free(fixupOffsetColumn);
+}
+
+- (const struct label_fixup *)fixups
+{
+	return fixups;
+}
+
+- (const uint32_t *)rowOffsets
+{
+	return rowOffsetColumn;
+}
+
+- (const uint16_t *)words
+{
+	return buffer;
+}
+
+- (NSData *)image
+{
+	return [NSData dataWithBytes:buffer length:wordCount * sizeof(uint16_t)];
+}
+
+- (int)addressOfSymbol:(int)symbol
+{
+	if(symbol < 0 || (NSUInteger) symbol >= self.table.symbolCount)
+	{
+		return UNDEFINED_LABEL;
+	}
+
+	return labelDef[symbol];
+}
+
+- (NSMutableArray *)program
+{
+	if(program == nil)
+	{
+		program = [[NSMutableArray alloc] initWithCapacity:wordCount];
+
+		for(NSUInteger i = 0; i < wordCount; i++)
+		{
+			[program addObject:[NSNumber numberWithInt:buffer[i]]];
+		}
+	}
+
+	return program;
+}
+
+- (void)resetStats
+{
+	memset(&stats, 0, sizeof(stats));
+}
 
 - (void)assembleStatments:(NSArray *)statments
 {
-	self.labelDef = [[NSMutableDictionary alloc] init];
-	self.labelRef = [[NSMutableDictionary alloc] init];
-	self.program = [[NSMutableArray alloc] init];
+	[self assembleStatmentTable:[StatmentTable tableWithStatments:statments]];
+}
+
+- (void)assembleStatmentTable:(StatmentTable *)statmentTable
+{
+	PIPELINE_STATS_START(start);
+
+	self.table = statmentTable;
+	self.program = nil;
+	wordCount = 0;
+	fixupCount = 0;
+
+	free(labelDef);
+	labelDef = malloc(MAX(statmentTable.symbolCount, 1) * sizeof(int));
+
+	for(NSUInteger symbol = 0; symbol < statmentTable.symbolCount; symbol++)
+	{
+		labelDef[symbol] = UNDEFINED_LABEL;
+	}
+
+	for(int operand = FIRST_OPERAND; operand <= SECOND_OPERAND; operand++)
+	{
+		free(relaxed[operand]);
+		relaxed[operand] = calloc(MAX(statmentTable.count, 1), sizeof(uint8_t));
+	}
+
+	relaxedReferenceCount = 0;
 
-	for(Statment *statment in statments)
+	free(rowOffsetColumn);
+	rowOffsetColumn = malloc(MAX(statmentTable.count, 1) * sizeof(uint32_t));
+	free(fixupOffsetColumn);
+	fixupOffsetColumn = malloc(MAX(statmentTable.count, 1) * sizeof(uint32_t));
+
+	if(self.relaxLabelReferences)
 	{
-		[self assembleStatment:statment];
+		[self relaxLabelOperands];
 	}
 
+	[self encodeStatments];
+	[self defineLabels];
 	[self resolveLabelReferences];
+
+	// labelDef, the two relaxed columns, rowOffsetColumn and fixupOffsetColumn.
+	PIPELINE_STATS_ADD(stats, allocations, 5);
+	PIPELINE_STATS_ADD(stats, statments, statmentTable.count);
+	PIPELINE_STATS_ADD(stats, fixups, fixupCount);
+	PIPELINE_STATS_STOP(stats, assembleTime, start);
+}
+
+// Statments only depend on each other through label addresses, which are patched
+// afterwards, so chunks of rows are first sized and then encoded concurrently. A prefix
+// sum over the chunk sizes gives every row a disjoint slice of the buffer and of the
+// fixup vector, which keeps both in the order a serial pass would produce.
+- (void)encodeStatments
+{
+	NSUInteger rows = self.table.count;
+	NSUInteger chunkSize = MAX(self.rowsPerChunk, 1);
+	NSUInteger chunkCount = (rows + chunkSize - 1) / chunkSize;
+	NSUInteger *chunkWords = calloc(MAX(chunkCount, 1), sizeof(NSUInteger));
+	NSUInteger *chunkFixups = calloc(MAX(chunkCount, 1), sizeof(NSUInteger));
+
+	// Nothing may be thrown out of a dispatch_apply block, so each chunk keeps what it
+	// caught and the failure of the earliest chunk is rethrown once every chunk is done.
+	__block NSString *failure = nil;
+	__block NSUInteger failedChunk = chunkCount;
+
+	void (^failChunk)(NSUInteger, NSString *) = ^(NSUInteger chunk, NSString *message)
+	{
+		@synchronized(self)
+		{
+			if(chunk < failedChunk)
+			{
+				failedChunk = chunk;
+				failure = message;
+			}
+		}
+	};
+
+	dispatch_apply(chunkCount, q_default, ^(size_t chunk)
+	{
+		@try
+		{
+			NSUInteger words = 0;
+			NSUInteger fixupsInChunk = 0;
+
+			for(NSUInteger row = chunk * chunkSize; row < MIN(rows, (chunk + 1) * chunkSize); row++)
+			{
+				rowOffsetColumn[row] = (uint32_t) words;
+				fixupOffsetColumn[row] = (uint32_t) fixupsInChunk;
+				words += [self sizeOfRow:row];
+				fixupsInChunk += [self fixupCountOfRow:row];
+			}
+
+			chunkWords[chunk] = words;
+			chunkFixups[chunk] = fixupsInChunk;
+		}
+		@catch(NSString *message)
+		{
+			failChunk(chunk, message);
+		}
+		@catch(NSException *exception)
+		{
+			failChunk(chunk, [NSString stringWithFormat:@"%@: %@", [exception name], [exception reason]]);
+		}
+	});
+
+	if(failure != nil)
+	{
+		free(chunkWords);
+		free(chunkFixups);
+		@throw failure;
+	}
+
+	NSUInteger totalWords = 0;
+	NSUInteger totalFixups = 0;
+
+	for(NSUInteger chunk = 0; chunk < chunkCount; chunk++)
+	{
+		NSUInteger words = chunkWords[chunk];
+		NSUInteger fixupsInChunk = chunkFixups[chunk];
+
+		chunkWords[chunk] = totalWords;
+		chunkFixups[chunk] = totalFixups;
+		totalWords += words;
+		totalFixups += fixupsInChunk;
+	}
+
+	[self ensureCapacityForWords:totalWords];
+	[self ensureCapacityForFixups:totalFixups];
+
+	dispatch_apply(chunkCount, q_default, ^(size_t chunk)
+	{
+		@try
+		{
+			for(NSUInteger row = chunk * chunkSize; row < MIN(rows, (chunk + 1) * chunkSize); row++)
+			{
+				rowOffsetColumn[row] += chunkWords[chunk];
+				fixupOffsetColumn[row] += chunkFixups[chunk];
+				[self assembleStatmentAtRow:row];
+			}
+		}
+		@catch(NSString *message)
+		{
+			failChunk(chunk, message);
+		}
+		@catch(NSException *exception)
+		{
+			failChunk(chunk, [NSString stringWithFormat:@"%@: %@", [exception name], [exception reason]]);
+		}
+	});
+
+	free(chunkWords);
+	free(chunkFixups);
+
+	if(failure != nil)
+	{
+		@throw failure;
+	}
+
+	wordCount = totalWords;
+	fixupCount = totalFixups;
+}
+
+- (void)defineLabels
+{
+	for(NSUInteger row = 0; row < self.table.count; row++)
+	{
+		int label = self.table.labels[row];
+
+		if(label != NO_SYMBOL)
+		{
+			labelDef[label] = (int) rowOffsetColumn[row];
+		}
+	}
+}
+
+// Shrinking an operand only ever moves later labels down, so an operand that fits a
+// short literal keeps fitting and the layout reaches a fixed point.
+- (void)relaxLabelOperands
+{
+	BOOL changed;
+
+	do
+	{
+		[self layoutLabels];
+
+		changed = NO;
+
+		for(NSUInteger row = 0; row < self.table.count; row++)
+		{
+			for(int operand = FIRST_OPERAND; operand <= SECOND_OPERAND; operand++)
+			{
+				if([self canRelaxOperand:operand atRow:row])
+				{
+					relaxed[operand][row] = YES;
+					relaxedReferenceCount++;
+					changed = YES;
+				}
+			}
+		}
+	} while(changed);
+}
+
+- (BOOL)canRelaxOperand:(int)operand atRow:(NSUInteger)row
+{
+	int label = [self.table operandSymbolsForOperand:operand][row];
+
+	if(relaxed[operand][row] || label == NO_SYMBOL || [self.table operandKindsForOperand:operand][row] != O_NEXT_WORD)
+	{
+		return NO;
+	}
+
+	return labelDef[label] != UNDEFINED_LABEL && labelDef[label] <= OPERAND_LITERAL_MAX;
+}
+
+- (void)layoutLabels
+{
+	NSUInteger address = 0;
+
+	for(NSUInteger row = 0; row < self.table.count; row++)
+	{
+		int label = self.table.labels[row];
+
+		if(label != NO_SYMBOL)
+		{
+			labelDef[label] = (int) address;
+		}
+
+		address += [self sizeOfRow:row];
+	}
+}
+
+- (NSUInteger)sizeOfRow:(NSUInteger)row
+{
+	NSData *include = [self.table binaryIncludeForRow:row];
+
+	if(include != nil)
+	{
+		return [include length] / sizeof(uint16_t);
+	}
+
+	if(self.table.datLengths[row] != 0)
+	{
+		return self.table.datLengths[row];
+	}
+
+	return 1 + [self sizeOfOperandNextWord:FIRST_OPERAND atRow:row] + [self sizeOfOperandNextWord:SECOND_OPERAND atRow:row];
+}
+
+- (NSUInteger)fixupCountOfRow:(NSUInteger)row
+{
+	if([self.table binaryIncludeForRow:row] != nil || self.table.datLengths[row] != 0)
+	{
+		return 0;
+	}
+
+	NSUInteger count = 0;
+
+	for(int operand = FIRST_OPERAND; operand <= SECOND_OPERAND; operand++)
+	{
+		if([self.table operandSymbolsForOperand:operand][row] != NO_SYMBOL && [self sizeOfOperandNextWord:operand atRow:row] != 0)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+- (NSUInteger)sizeOfOperandNextWord:(int)operand atRow:(NSUInteger)row
+{
+	uint16_t kind = [self.table operandKindsForOperand:operand][row];
+
+	if(kind != O_NEXT_WORD && kind != O_INDIRECT_NEXT_WORD && kind != O_INDIRECT_NEXT_WORD_OFFSET)
+	{
+		return 0;
+	}
+
+	if([self.table operandSymbolsForOperand:operand][row] != NO_SYMBOL)
+	{
+		return relaxed[operand][row] ? 0 : 1;
+	}
+
+	return [self.table operandNextWordsForOperand:operand][row] > OPERAND_LITERAL_MAX ? 1 : 0;
+}
+
+- (void)ensureCapacityForWords:(NSUInteger)count
+{
+	if(wordCount + count <= wordCapacity)
+	{
+		return;
+	}
+
+	wordCapacity = wordCapacity == 0 ? INITIAL_WORD_CAPACITY : wordCapacity;
+
+	while(wordCount + count > wordCapacity)
+	{
+		wordCapacity *= 2;
+	}
+
+	buffer = realloc(buffer, wordCapacity * sizeof(uint16_t));
+	PIPELINE_STATS_ADD(stats, allocations, 1);
 }
 
-- (void)assembleStatment:(Statment *)statment
+- (void)ensureCapacityForFixups:(NSUInteger)count
 {
-	int opCode = statment.opcode;
+	if(fixupCount + count <= fixupCapacity)
+	{
+		return;
+	}
+
+	fixupCapacity = fixupCapacity == 0 ? INITIAL_FIXUP_CAPACITY : fixupCapacity;
 
-	[self processLabelInStatment:statment];
+	while(fixupCount + count > fixupCapacity)
+	{
+		fixupCapacity *= 2;
+	}
+
+	fixups = realloc(fixups, fixupCapacity * sizeof(struct label_fixup));
+	PIPELINE_STATS_ADD(stats, allocations, 1);
+}
 
-	if([self processDatInStament:statment])
+- (void)assembleStatmentAtRow:(NSUInteger)row
+{
+	int opCode = self.table.opcodes[row];
+	struct encode_cursor cursor = {rowOffsetColumn[row], fixupOffsetColumn[row]};
+
+	if([self processDatAtRow:row cursor:&cursor])
 	{
 		return;
 	}
 
-	if(statment.opcode == 0)
+	if(opCode == 0)
 	{
-		if(![statment.secondOperand isKindOfClass:[NullOperand class]])
+		if([self.table operandKindsForOperand:SECOND_OPERAND][row] != O_NULL)
 		{
 			@throw @"Non-basic opcode must have single operand.";
 		}
 
-		switch(statment.opcodeNonBasic)
+		switch(self.table.opcodesNonBasic[row])
 		{
 			case OP_JSR:
 			{
 				opCode = 0;
 				opCode |= OP_JSR << OPCODE_WIDTH;
-				opCode |= [self assembleOperand:statment.firstOperand forOpCode:0 withIndex:1];
-				[self addOpCode:opCode];
-				[self assembleOperandNextWord:statment.firstOperand];
+				opCode |= [self assembleOperand:FIRST_OPERAND atRow:row withIndex:1];
+				[self addOpCode:opCode cursor:&cursor];
+				[self assembleOperandNextWord:FIRST_OPERAND atRow:row cursor:&cursor];
 				break;
 			}
 			default:
@@ -92,79 +493,133 @@
 	}
 	else
 	{
-		opCode = [self assembleOperand:statment.firstOperand forOpCode:opCode withIndex:0];
-		opCode = [self assembleOperand:statment.secondOperand forOpCode:opCode withIndex:1];
+		opCode |= [self assembleOperand:FIRST_OPERAND atRow:row withIndex:0];
+		opCode |= [self assembleOperand:SECOND_OPERAND atRow:row withIndex:1];
 
-		[self addOpCode:opCode];
+		[self addOpCode:opCode cursor:&cursor];
 
-		[self assembleOperandNextWord:statment.firstOperand];
-		[self assembleOperandNextWord:statment.secondOperand];
+		[self assembleOperandNextWord:FIRST_OPERAND atRow:row cursor:&cursor];
+		[self assembleOperandNextWord:SECOND_OPERAND atRow:row cursor:&cursor];
 	}
 }
 
-- (void)processLabelInStatment:(Statment *)statment
+- (BOOL)processDatAtRow:(NSUInteger)row cursor:(struct encode_cursor *)cursor
 {
-	if([statment.label length] > 0)
-	{
-		[self.labelDef setObject:[NSNumber numberWithInt:[program count]] forKey:[statment.label substringFromIndex:1]];
-	}
-}
+	NSData *include = [self.table binaryIncludeForRow:row];
 
-- (BOOL)processDatInStament:(Statment *)statment
-{
-	if([statment.dat count] != 0)
+	if(include != nil)
 	{
-		for(NSNumber *value in statment.dat)
+		const uint16_t *included = [include bytes];
+		NSUInteger length = [include length] / sizeof(uint16_t);
+
+		for(NSUInteger i = 0; i < length; i++)
 		{
-			[self addOpCode:[value intValue]];
+			buffer[cursor->word + i] = CFSwapInt16BigToHost(included[i]);
 		}
 
+		cursor->word += length;
+
+		return YES;
+	}
+
+	uint32_t length = self.table.datLengths[row];
+
+	if(length != 0)
+	{
+		memcpy(buffer + cursor->word, self.table.datArena + self.table.datOffsets[row], length * sizeof(uint16_t));
+		cursor->word += length;
+
 		return YES;
 	}
 
 	return NO;
 }
 
-- (void)addOpCode:(int)opCode
+- (void)addOpCode:(int)opCode cursor:(struct encode_cursor *)cursor
 {
-	[program addObject:[NSNumber numberWithInt:opCode]];
+	buffer[cursor->word] = (uint16_t) opCode;
+	cursor->word++;
 }
 
-- (int)assembleOperand:(Operand *)operand forOpCode:(int)opCode withIndex:(int)index
+- (void)addFixupForSymbol:(int)symbol cursor:(struct encode_cursor *)cursor
 {
-	return opCode |= [operand assembleOperandWithIndex:index];
+	fixups[cursor->fixup].offset = (uint32_t) cursor->word;
+	fixups[cursor->fixup].symbol = symbol;
+	cursor->fixup++;
 }
 
-- (void)assembleOperandNextWord:(Operand *)operand
+- (int)assembleOperand:(int)operand atRow:(NSUInteger)row withIndex:(int)index
 {
-	if([operand isKindOfClass:[NextWordOperand class]] || [operand isKindOfClass:[IndirectNextWordOperand class]] ||
-	   [operand isKindOfClass:[IndirectNextWordOffsetOperand class]])
+	int shift = OPCODE_WIDTH + (index * OPERAND_WIDTH);
+	uint16_t kind = [self.table operandKindsForOperand:operand][row];
+	uint16_t nextWord = [self.table operandNextWordsForOperand:operand][row];
+	int label = [self.table operandSymbolsForOperand:operand][row];
+	BOOL hasLabel = label != NO_SYMBOL;
+
+	switch(kind)
 	{
-		if([operand.label length] > 0)
+		case O_REG:
+		case O_INDIRECT_REG:
+		case O_INDIRECT_NEXT_WORD_OFFSET:
+			return (kind + [self.table operandRegistersForOperand:operand][row]) << shift;
+		case O_POP:
+		case O_PEEK:
+		case O_PUSH:
+		case O_SP:
+		case O_PC:
+		case O_O:
+			return kind << shift;
+		case O_INDIRECT_NEXT_WORD:
+		case O_NEXT_WORD:
+			if(hasLabel && relaxed[operand][row])
+			{
+				return (labelDef[label] + OPERAND_LITERAL_OFFSET) << shift;
+			}
+			if(nextWord <= OPERAND_LITERAL_MAX && !hasLabel)
+			{
+				return (nextWord + OPERAND_LITERAL_OFFSET) << shift;
+			}
+			return kind << shift;
+		default:
+			return 0;
+	}
+}
+
+- (void)assembleOperandNextWord:(int)operand atRow:(NSUInteger)row cursor:(struct encode_cursor *)cursor
+{
+	uint16_t kind = [self.table operandKindsForOperand:operand][row];
+
+	if(kind == O_NEXT_WORD || kind == O_INDIRECT_NEXT_WORD || kind == O_INDIRECT_NEXT_WORD_OFFSET)
+	{
+		int label = [self.table operandSymbolsForOperand:operand][row];
+		uint16_t nextWord = [self.table operandNextWordsForOperand:operand][row];
+
+		if(label != NO_SYMBOL && relaxed[operand][row])
+		{
+			return;
+		}
+
+		if(label != NO_SYMBOL)
 		{
-			[self.labelRef setObject:operand.label forKey:[NSNumber numberWithInt:[self.program count]]];
-			[self addOpCode:0];
+			[self addFixupForSymbol:label cursor:cursor];
+			[self addOpCode:0 cursor:cursor];
 		}
-		else if(operand.nextWord > OPERAND_LITERAL_MAX)
+		else if(nextWord > OPERAND_LITERAL_MAX)
 		{
-			[self addOpCode:operand.nextWord];
+			[self addOpCode:nextWord cursor:cursor];
 		}
 	}
 }
 
 - (void)resolveLabelReferences
 {
-	for(NSNumber *instruction in labelRef.keyEnumerator)
+	for(NSUInteger i = 0; i < fixupCount; i++)
 	{
-		NSString *label = [labelRef objectForKey:instruction];
-
-		BOOL containsKey = ([labelDef objectForKey:label] != nil);
+		int address = labelDef[fixups[i].symbol];
 
-		if(containsKey)
+		if(address != UNDEFINED_LABEL)
 		{
-			NSUInteger index = (NSUInteger) [instruction intValue];
-			NSNumber *key = [labelDef objectForKey:label];
-			[self.program replaceObjectAtIndex:index withObject:key];
+			buffer[fixups[i].offset] = (uint16_t) address;
 		}
 	}
 }
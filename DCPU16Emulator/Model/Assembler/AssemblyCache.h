@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "ParallelParser.h"
+
+#define DEFAULT_ASSEMBLY_CACHE_BYTES (4 * 1024 * 1024)
+
+@class CachedAssembly;
+@class AssemblyMemoryCache;
+
+// Content addressed cache in front of Assembler. Sources are keyed by a hash of their
+// UTF-8 bytes and the assembler options, so a repeated source comes back without being
+// lexed, parsed or assembled. Entries live in a byte bounded LRU and, when a directory
+// is set, as a mappable image file plus a symbol file per key. Not thread safe.
+@interface AssemblyCache : NSObject
+
+@property(nonatomic, strong, readonly) AssemblyMemoryCache *memoryCache;
+
+// Directory of the on-disk store; nil keeps entries in memory only.
+@property(nonatomic, copy) NSString *directory;
+
+@property(nonatomic, assign) BOOL relaxLabelReferences;
+
+// Used for sources with .incbin, which are never cached since the included files
+// are not part of the key.
+@property(nonatomic, copy) NSString *includeDirectory;
+
+@property(nonatomic, copy) createLexer lexerFactory;
+
+@property(nonatomic, readonly) NSUInteger memoryHitCount;
+@property(nonatomic, readonly) NSUInteger diskHitCount;
+@property(nonatomic, readonly) NSUInteger missCount;
+
+- (id)initWithDirectory:(NSString *)directory;
+
+// Throws the parser's message when the source does not assemble; nothing is cached then.
+- (CachedAssembly *)assembleSource:(NSString *)source;
+
+- (NSString *)keyForSource:(NSString *)source;
+
+// NO when the source has an .incbin directive. Only sources that mention .incbin are
+// lexed, so the text inside comments and strings does not count.
+- (BOOL)isCacheableSource:(NSString *)source;
+
+// Drops the memory entries and the image and symbol files this cache wrote; other
+// files in the directory are left alone.
+- (void)removeAllObjects;
+
+@end
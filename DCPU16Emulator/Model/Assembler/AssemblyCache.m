@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblyCache.h"
+#import "AssemblyMemoryCache.h"
+#import "CachedAssembly.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "StatmentTable.h"
+#import "SymbolTable.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+
+// Bump when the layout of the image or symbol files changes so stale files miss.
+#define ASSEMBLY_CACHE_FORMAT 1
+
+@interface AssemblyCache ()
+
+@property(nonatomic, strong, readwrite) AssemblyMemoryCache *memoryCache;
+
+@end
+
+@implementation AssemblyCache
+
+@synthesize memoryCache;
+@synthesize directory;
+@synthesize relaxLabelReferences;
+@synthesize includeDirectory;
+@synthesize lexerFactory;
+@synthesize memoryHitCount;
+@synthesize diskHitCount;
+@synthesize missCount;
+
+- (id)init
+{
+	return [self initWithDirectory:nil];
+}
+
+- (id)initWithDirectory:(NSString *)theDirectory
+{
+	self = [super init];
+
+	self.directory = theDirectory;
+	self.memoryCache = [[AssemblyMemoryCache alloc] initWithCapacity:0];
+	self.memoryCache.maxNumberOfBytes = DEFAULT_ASSEMBLY_CACHE_BYTES;
+	self.lexerFactory = ^
+	{
+		return (id <LexerProtocol>) [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														   consumeTokenStrategy:[[ConsumeToken alloc] init]];
+	};
+
+	return self;
+}
+
+static uint64_t hashBytes(uint64_t hash, const uint8_t *bytes, NSUInteger length)
+{
+	for(NSUInteger i = 0; i < length; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+- (NSString *)keyForSource:(NSString *)source
+{
+	const char *bytes = CFStringGetCStringPtr((__bridge CFStringRef) source, kCFStringEncodingUTF8);
+
+	if(bytes == NULL)
+	{
+		bytes = [source UTF8String];
+	}
+
+	uint8_t options[2] = {ASSEMBLY_CACHE_FORMAT, self.relaxLabelReferences ? 1 : 0};
+	uint64_t hash = hashBytes(14695981039346656037ull, options, sizeof(options));
+	hash = hashBytes(hash, (const uint8_t *) bytes, strlen(bytes));
+
+	return [NSString stringWithFormat:@"%016llx", hash];
+}
+
+- (CachedAssembly *)assembleSource:(NSString *)source
+{
+	if(![self isCacheableSource:source])
+	{
+		missCount++;
+		return [self assembleUncachedSource:source];
+	}
+
+	NSString *key = [self keyForSource:source];
+	CachedAssembly *entry = [self.memoryCache objectWithName:key];
+
+	if(entry != nil)
+	{
+		memoryHitCount++;
+		return entry;
+	}
+
+	entry = [self readEntryWithKey:key];
+
+	if(entry != nil)
+	{
+		diskHitCount++;
+	}
+	else
+	{
+		missCount++;
+		entry = [self assembleUncachedSource:source];
+		[self writeEntry:entry withKey:key];
+	}
+
+	[self.memoryCache storeObject:entry withName:key];
+
+	return entry;
+}
+
+- (BOOL)isCacheableSource:(NSString *)source
+{
+	if([source rangeOfString:@".incbin" options:NSCaseInsensitiveSearch].location == NSNotFound)
+	{
+		return YES;
+	}
+
+	id <LexerProtocol> lexer = self.lexerFactory();
+
+	@try
+	{
+		[lexer lexSource:source];
+
+		while([lexer nextToken])
+		{
+			if(lexer.token == DIRECTIVE)
+			{
+				return NO;
+			}
+		}
+	}
+	@catch(NSString *message)
+	{
+		// Does not assemble either, so there is nothing to cache.
+		return NO;
+	}
+
+	return YES;
+}
+
+- (CachedAssembly *)assembleUncachedSource:(NSString *)source
+{
+	Parser *parser = [[Parser alloc] init];
+	parser.includeDirectory = self.includeDirectory;
+
+	StatmentTable *table = [[StatmentTable alloc] init];
+	[parser parseSource:source withLexer:self.lexerFactory() intoTable:table];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	assembler.relaxLabelReferences = self.relaxLabelReferences;
+	[assembler assembleStatmentTable:table];
+
+	return [[CachedAssembly alloc] initWithAssembler:assembler symbols:table.symbols];
+}
+
+- (NSString *)pathForKey:(NSString *)key extension:(NSString *)extension
+{
+	return [[self.directory stringByAppendingPathComponent:key] stringByAppendingPathExtension:extension];
+}
+
+// The image is mapped rather than read so a large program costs no copy until touched.
+- (CachedAssembly *)readEntryWithKey:(NSString *)key
+{
+	if(self.directory == nil)
+	{
+		return nil;
+	}
+
+	NSData *image = [NSData dataWithContentsOfFile:[self pathForKey:key extension:@"img"]
+										   options:NSDataReadingMappedIfSafe
+											 error:nil];
+	NSData *records = [NSData dataWithContentsOfFile:[self pathForKey:key extension:@"sym"]
+											 options:NSDataReadingMappedIfSafe
+											   error:nil];
+
+	if(image == nil || records == nil)
+	{
+		return nil;
+	}
+
+	return [[CachedAssembly alloc] initWithImage:image symbolRecords:records];
+}
+
+// Symbols are written before the image and both atomically, so a reader that finds
+// the image also finds complete symbols.
+- (void)writeEntry:(CachedAssembly *)entry withKey:(NSString *)key
+{
+	if(self.directory == nil)
+	{
+		return;
+	}
+
+	[[NSFileManager defaultManager] createDirectoryAtPath:self.directory
+							  withIntermediateDirectories:YES
+											   attributes:nil
+													error:nil];
+
+	if([entry.symbolRecords writeToFile:[self pathForKey:key extension:@"sym"] options:NSDataWritingAtomic error:nil])
+	{
+		[entry.image writeToFile:[self pathForKey:key extension:@"img"] options:NSDataWritingAtomic error:nil];
+	}
+}
+
+- (void)removeAllObjects
+{
+	[self.memoryCache removeAllObjects];
+
+	if(self.directory == nil)
+	{
+		return;
+	}
+
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	NSCharacterSet *notHex = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+
+	for(NSString *name in [fileManager contentsOfDirectoryAtPath:self.directory error:nil])
+	{
+		NSString *extension = [name pathExtension];
+		NSString *key = [name stringByDeletingPathExtension];
+
+		if(([extension isEqualToString:@"img"] || [extension isEqualToString:@"sym"])
+				&& [key length] == 16 && [key rangeOfCharacterFromSet:notHex].location == NSNotFound)
+		{
+			[fileManager removeItemAtPath:[self.directory stringByAppendingPathComponent:name] error:nil];
+		}
+	}
+}
+
+@end
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblyMemoryCache.h"
+#import "CachedAssembly.h"
+
+@interface AssemblyMemoryCache ()
+
+@property(nonatomic, readwrite) NSUInteger numberOfBytes;
+
+@end
+
+@implementation AssemblyMemoryCache
+
+@synthesize numberOfBytes;
+@synthesize maxNumberOfBytes;
+@synthesize maxNumberOfBytesUnderStress;
+
+- (void)removeAllObjects
+{
+	[super removeAllObjects];
+
+	self.numberOfBytes = 0;
+}
+
+- (void)reduceMemoryUsage
+{
+	[super reduceMemoryUsage];
+
+	if(self.maxNumberOfBytesUnderStress > 0)
+	{
+		[self evictDownToNumberOfBytes:self.maxNumberOfBytesUnderStress];
+	}
+}
+
+- (void)evictDownToNumberOfBytes:(NSUInteger)limit
+{
+	while(self.numberOfBytes > limit && [self count] > 0)
+	{
+		// Expired entries are dropped while looking up the oldest name, which then comes back nil.
+		NSString *name = [self nameOfLeastRecentlyUsedObject];
+
+		if(name != nil)
+		{
+			[self removeObjectWithName:name];
+		}
+	}
+}
+
+- (BOOL)willSetObject:(id)object withName:(NSString *)name previousObject:(id)previousObject
+{
+	if(![object isKindOfClass:[CachedAssembly class]])
+	{
+		return NO;
+	}
+
+	self.numberOfBytes -= [previousObject byteCost];
+	self.numberOfBytes += [object byteCost];
+
+	return YES;
+}
+
+// Evict after the entry is in place so an entry larger than the whole budget can
+// evict itself instead of looping on an empty list.
+- (void)didSetObject:(id)object withName:(NSString *)name
+{
+	if(self.maxNumberOfBytes > 0)
+	{
+		[self evictDownToNumberOfBytes:self.maxNumberOfBytes];
+	}
+}
+
+- (void)willRemoveObject:(id)object withName:(NSString *)name
+{
+	self.numberOfBytes -= [object byteCost];
+}
+
+@end
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class AssemblyCache;
+@class CachedAssembly;
+@class AssemblyQueue;
+
+typedef void(^assemblyCompletion)(CachedAssembly *assembly, NSString *errorMessage);
+
+// One caller's interest in an assemble job; cancelling it never affects other callers
+// waiting on the same source.
+@interface AssemblyRequest : NSObject
+
+@property(nonatomic, copy, readonly) NSString *key;
+@property(nonatomic, readonly) BOOL isCancelled;
+
+- (void)cancel;
+
+@end
+
+// Runs AssembleOperations on an NSOperationQueue. Requests for a source whose key is
+// already in flight join that job instead of starting another, and the finished result
+// goes to every request still waiting and into the cache's memory LRU. Requests are
+// submitted and cancelled on the main thread, where completions are delivered too.
+@interface AssemblyQueue : NSObject
+
+@property(nonatomic, strong, readonly) NSOperationQueue *operationQueue;
+
+// Supplies the keys, the assembler options and a memory LRU that is checked before a
+// job is queued.
+@property(nonatomic, strong, readonly) AssemblyCache *cache;
+
+@property(nonatomic, readonly) NSUInteger startedJobCount;
+@property(nonatomic, readonly) NSUInteger joinedRequestCount;
+
+- (id)initWithCache:(AssemblyCache *)cache;
+
+- (AssemblyRequest *)assembleSource:(NSString *)source
+						   priority:(NSOperationQueuePriority)priority
+						 completion:(assemblyCompletion)completion;
+
+@end
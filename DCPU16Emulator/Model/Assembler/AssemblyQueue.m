@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblyQueue.h"
+#import "AssembleOperation.h"
+#import "AssemblyCache.h"
+#import "AssemblyMemoryCache.h"
+#import "CachedAssembly.h"
+
+@interface AssemblyRequest ()
+
+@property(nonatomic, copy, readwrite) NSString *key;
+@property(nonatomic, readwrite) BOOL isCancelled;
+@property(nonatomic, copy) assemblyCompletion completion;
+@property(nonatomic, weak) AssemblyQueue *queue;
+
+@end
+
+@interface AssemblyQueue ()
+
+@property(nonatomic, strong, readwrite) NSOperationQueue *operationQueue;
+@property(nonatomic, strong, readwrite) AssemblyCache *cache;
+@property(nonatomic, strong) NSMutableDictionary *operationsInFlight;
+@property(nonatomic, strong) NSMutableDictionary *waitingRequests;
+@property(nonatomic, readwrite) NSUInteger startedJobCount;
+@property(nonatomic, readwrite) NSUInteger joinedRequestCount;
+
+- (void)cancelRequest:(AssemblyRequest *)request;
+
+@end
+
+@implementation AssemblyRequest
+
+@synthesize key;
+@synthesize isCancelled;
+@synthesize completion;
+@synthesize queue;
+
+- (void)cancel
+{
+	if(self.isCancelled)
+	{
+		return;
+	}
+
+	self.isCancelled = YES;
+	[self.queue cancelRequest:self];
+}
+
+@end
+
+@implementation AssemblyQueue
+
+@synthesize operationQueue;
+@synthesize cache;
+@synthesize operationsInFlight;
+@synthesize waitingRequests;
+@synthesize startedJobCount;
+@synthesize joinedRequestCount;
+
+- (id)init
+{
+	return [self initWithCache:[[AssemblyCache alloc] init]];
+}
+
+- (id)initWithCache:(AssemblyCache *)theCache
+{
+	self = [super init];
+
+	self.cache = theCache;
+	self.operationQueue = [[NSOperationQueue alloc] init];
+	self.operationsInFlight = [[NSMutableDictionary alloc] init];
+	self.waitingRequests = [[NSMutableDictionary alloc] init];
+
+	return self;
+}
+
+- (AssemblyRequest *)assembleSource:(NSString *)source
+						   priority:(NSOperationQueuePriority)priority
+						 completion:(assemblyCompletion)completion
+{
+	AssemblyRequest *request = [[AssemblyRequest alloc] init];
+	request.key = [self.cache keyForSource:source];
+	request.completion = completion;
+	request.queue = self;
+
+	CachedAssembly *cached = [self.cache.memoryCache objectWithName:request.key];
+
+	if(cached != nil)
+	{
+		dispatch_async(dispatch_get_main_queue(), ^
+		{
+			if(!request.isCancelled)
+			{
+				request.completion(cached, nil);
+			}
+		});
+
+		return request;
+	}
+
+	AssembleOperation *operation = [self.operationsInFlight objectForKey:request.key];
+
+	if(operation != nil)
+	{
+		self.joinedRequestCount++;
+
+		if(priority > [operation queuePriority])
+		{
+			[operation setQueuePriority:priority];
+		}
+
+		[[self.waitingRequests objectForKey:request.key] addObject:request];
+
+		return request;
+	}
+
+	operation = [self operationForSource:source key:request.key];
+	[operation setQueuePriority:priority];
+
+	[self.operationsInFlight setObject:operation forKey:request.key];
+	[self.waitingRequests setObject:[NSMutableArray arrayWithObject:request] forKey:request.key];
+
+	self.startedJobCount++;
+	[self.operationQueue addOperation:operation];
+
+	return request;
+}
+
+- (AssembleOperation *)operationForSource:(NSString *)source key:(NSString *)key
+{
+	AssembleOperation *operation = [[AssembleOperation alloc] initWithSource:source key:key];
+	operation.relaxLabelReferences = self.cache.relaxLabelReferences;
+	operation.includeDirectory = self.cache.includeDirectory;
+
+	__weak AssemblyQueue *weakSelf = self;
+
+	operation.didFinishBlock = ^(NIOperation *finished)
+	{
+		[weakSelf operationDidEnd:(AssembleOperation *) finished];
+	};
+
+	operation.didFailWithErrorBlock = ^(NIOperation *failed, NSError *error)
+	{
+		[weakSelf operationDidEnd:(AssembleOperation *) failed];
+	};
+
+	return operation;
+}
+
+- (void)operationDidEnd:(AssembleOperation *)operation
+{
+	if([self.operationsInFlight objectForKey:operation.key] != operation)
+	{
+		return;
+	}
+
+	NSArray *requests = [self.waitingRequests objectForKey:operation.key];
+
+	[self.operationsInFlight removeObjectForKey:operation.key];
+	[self.waitingRequests removeObjectForKey:operation.key];
+
+	// .incbin sources depend on files outside the key, so they are never cached.
+	if(operation.result != nil && [self.cache isCacheableSource:operation.source])
+	{
+		[self.cache.memoryCache storeObject:operation.result withName:operation.key];
+	}
+
+	for(AssemblyRequest *request in requests)
+	{
+		if(!request.isCancelled)
+		{
+			request.completion(operation.result, operation.errorMessage);
+		}
+	}
+}
+
+- (void)cancelRequest:(AssemblyRequest *)request
+{
+	NSMutableArray *requests = [self.waitingRequests objectForKey:request.key];
+
+	[requests removeObjectIdenticalTo:request];
+
+	if(requests == nil || [requests count] > 0)
+	{
+		return;
+	}
+
+	[[self.operationsInFlight objectForKey:request.key] cancel];
+	[self.operationsInFlight removeObjectForKey:request.key];
+	[self.waitingRequests removeObjectForKey:request.key];
+}
+
+@end
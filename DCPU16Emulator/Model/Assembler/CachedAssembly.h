@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class Assembler;
+@class SymbolTable;
+
+// Image and symbols of one assembled source as kept by AssemblyCache. The symbol
+// records are stored flat so the entry can be written to disk and costed in bytes
+// without walking the symbol table.
+@interface CachedAssembly : NSObject
+
+@property(nonatomic, strong, readonly) NSData *image;
+
+// Per symbol: address, definition line, name length, then the name bytes.
+@property(nonatomic, strong, readonly) NSData *symbolRecords;
+
+// Rebuilt from symbolRecords on first access when the entry was loaded from disk.
+@property(nonatomic, strong, readonly) SymbolTable *symbols;
+
+@property(nonatomic, readonly) NSUInteger byteCost;
+
+- (id)initWithImage:(NSData *)image symbolRecords:(NSData *)records;
+
+- (id)initWithAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols;
+
+- (int)addressOfSymbol:(int)symbol;
+
+- (int)addressOfLabel:(NSString *)name;
+
+@end
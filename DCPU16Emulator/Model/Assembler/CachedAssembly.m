@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "CachedAssembly.h"
+#import "Assembler.h"
+#import "SymbolTable.h"
+
+struct symbol_record
+{
+	int32_t address;
+	int32_t line;
+	uint32_t length;
+};
+
+@interface CachedAssembly ()
+
+@property(nonatomic, strong, readwrite) NSData *image;
+@property(nonatomic, strong, readwrite) NSData *symbolRecords;
+@property(nonatomic, strong, readwrite) SymbolTable *symbols;
+
+@end
+
+@implementation CachedAssembly
+{
+	int32_t *addresses;
+}
+
+@synthesize image;
+@synthesize symbolRecords;
+@synthesize symbols;
+
+- (void)dealloc
+{
+	free(addresses);
+}
+
+- (id)initWithImage:(NSData *)theImage symbolRecords:(NSData *)records
+{
+	self = [super init];
+
+	self.image = theImage;
+	self.symbolRecords = records;
+
+	return self;
+}
+
+- (id)initWithAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbolTable
+{
+	self = [super init];
+
+	self.image = [assembler image];
+	self.symbols = symbolTable;
+
+	NSMutableData *records = [NSMutableData data];
+	addresses = malloc(MAX(symbolTable.count, 1) * sizeof(int32_t));
+
+	for(NSUInteger symbol = 0; symbol < symbolTable.count; symbol++)
+	{
+		const char *name = [[symbolTable nameForSymbol:(int) symbol] UTF8String];
+		struct symbol_record record;
+
+		record.address = [assembler addressOfSymbol:(int) symbol];
+		record.line = [symbolTable definitionLineForSymbol:(int) symbol];
+		record.length = (uint32_t) strlen(name);
+
+		[records appendBytes:&record length:sizeof(record)];
+		[records appendBytes:name length:record.length];
+
+		addresses[symbol] = record.address;
+	}
+
+	self.symbolRecords = records;
+
+	return self;
+}
+
+- (NSUInteger)byteCost
+{
+	return [self.image length] + [self.symbolRecords length];
+}
+
+- (SymbolTable *)symbols
+{
+	if(symbols == nil)
+	{
+		[self loadSymbolRecords];
+	}
+
+	return symbols;
+}
+
+- (void)loadSymbolRecords
+{
+	SymbolTable *symbolTable = [[SymbolTable alloc] init];
+	NSMutableData *addressColumn = [NSMutableData data];
+	const uint8_t *bytes = [self.symbolRecords bytes];
+	NSUInteger length = [self.symbolRecords length];
+	NSUInteger position = 0;
+
+	while(position + sizeof(struct symbol_record) <= length)
+	{
+		struct symbol_record record;
+		memcpy(&record, bytes + position, sizeof(record));
+		position += sizeof(record);
+
+		if(position + record.length > length)
+		{
+			@throw @"Corrupt symbol records";
+		}
+
+		int symbol = [symbolTable symbolForBytes:(const char *) bytes + position length:record.length];
+		[symbolTable defineSymbol:symbol atLine:record.line];
+		[addressColumn appendBytes:&record.address length:sizeof(int32_t)];
+
+		position += record.length;
+	}
+
+	free(addresses);
+	addresses = malloc(MAX([addressColumn length], 1));
+	memcpy(addresses, [addressColumn bytes], [addressColumn length]);
+
+	self.symbols = symbolTable;
+}
+
+- (int)addressOfSymbol:(int)symbol
+{
+	if(symbol < 0 || (NSUInteger) symbol >= self.symbols.count)
+	{
+		return UNDEFINED_LABEL;
+	}
+
+	return addresses[symbol];
+}
+
+- (int)addressOfLabel:(NSString *)name
+{
+	return [self addressOfSymbol:[self.symbols lookupName:name]];
+}
+
+@end
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "PipelineStats.h"
+
+@class SymbolTable;
+@class Statment;
+
+// Keeps the encoded image, the per-line word offsets, the symbol table and the label
+// fixups between runs. An edit re-encodes only the replaced lines, moves the words
+// after them only when the encoded size changed, and re-patches label operands.
+// Expects one statment per source line; label references always take a next word,
+// so an edit never forces the rest of the program to be laid out again.
+@interface IncrementalAssembler : NSObject
+
+@property(nonatomic, readonly) const uint16_t *words;
+@property(nonatomic, readonly) NSUInteger wordCount;
+@property(nonatomic, readonly) NSUInteger lineCount;
+@property(nonatomic, strong, readonly) SymbolTable *symbols;
+
+// Lexer, parser and assembler counters of every run that reassembled lines, until reset.
+@property(nonatomic, readonly) struct pipeline_stats stats;
+
+- (void)resetStats;
+
+// Diffs lines against the previous run and reassembles the lines in between the
+// common prefix and suffix. Returns the changed word ranges, sorted and merged, as
+// NSValue wrapped NSRanges.
+- (NSArray *)assembleLines:(NSArray *)lines;
+
+// Same diff for programs built in code: lines are any objects compared with isEqual:
+// and the block lowers each replaced one straight into a statment, with no text to lex.
+- (NSArray *)assembleLines:(NSArray *)lines lowering:(Statment *(^)(id line))lower;
+
+- (NSArray *)replaceLinesInRange:(NSRange)range withLines:(NSArray *)lines;
+
+- (NSArray *)replaceLinesInRange:(NSRange)range withLines:(NSArray *)lines lowering:(Statment *(^)(id line))lower;
+
+- (NSData *)image;
+
+@end
@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "IncrementalAssembler.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "StatmentTable.h"
+#import "SymbolTable.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+
+#define UNDEFINED_SYMBOL_LINE -1
+
+@interface IncrementalAssembler ()
+{
+	uint16_t *buffer;
+	NSUInteger wordCapacity;
+
+	uint32_t *lineOffsets;
+	int32_t *lineLabels;
+	NSUInteger lineCapacity;
+
+	struct label_fixup *fixups;
+	NSUInteger fixupCount;
+	NSUInteger fixupCapacity;
+
+	int32_t *symbolLines;
+	NSUInteger symbolCapacity;
+}
+
+@property(nonatomic, strong) NSMutableArray *lines;
+@property(nonatomic, strong, readwrite) SymbolTable *symbols;
+@property(nonatomic, strong) Parser *parser;
+
+@end
+
+@implementation IncrementalAssembler
+
+@synthesize wordCount;
+@synthesize lines;
+@synthesize symbols;
+@synthesize parser;
+@synthesize stats;
+
+- (id)init
+{
+	self = [super init];
+
+	self.lines = [[NSMutableArray alloc] init];
+	self.symbols = [[SymbolTable alloc] init];
+	self.parser = [[Parser alloc] init];
+
+	lineOffsets = calloc(1, sizeof(uint32_t));
+	lineLabels = calloc(1, sizeof(int32_t));
+	lineCapacity = 1;
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(buffer);
+	free(lineOffsets);
+	free(lineLabels);
+	free(fixups);
+	free(symbolLines);
+}
+
+- (void)resetStats
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+- (const uint16_t *)words
+{
+	return buffer;
+}
+
+- (NSUInteger)lineCount
+{
+	return [self.lines count];
+}
+
+- (NSData *)image
+{
+	return [NSData dataWithBytes:buffer length:wordCount * sizeof(uint16_t)];
+}
+
+- (NSArray *)assembleLines:(NSArray *)newLines
+{
+	return [self assembleLines:newLines lowering:nil];
+}
+
+- (NSArray *)assembleLines:(NSArray *)newLines lowering:(Statment *(^)(id line))lower
+{
+	NSUInteger oldCount = [self.lines count];
+	NSUInteger newCount = [newLines count];
+	NSUInteger prefix = 0;
+	NSUInteger suffix = 0;
+
+	while(prefix < oldCount && prefix < newCount
+			&& [[self.lines objectAtIndex:prefix] isEqual:[newLines objectAtIndex:prefix]])
+	{
+		prefix++;
+	}
+
+	while(suffix < oldCount - prefix && suffix < newCount - prefix
+			&& [[self.lines objectAtIndex:oldCount - suffix - 1] isEqual:[newLines objectAtIndex:newCount - suffix - 1]])
+	{
+		suffix++;
+	}
+
+	if(prefix == oldCount && prefix == newCount)
+	{
+		return [NSArray array];
+	}
+
+	NSRange range = NSMakeRange(prefix, oldCount - prefix - suffix);
+	NSArray *addedLines = [newLines subarrayWithRange:NSMakeRange(prefix, newCount - prefix - suffix)];
+
+	if(lower == nil)
+	{
+		return [self replaceLinesInRange:range withLines:addedLines];
+	}
+
+	return [self replaceLinesInRange:range withLines:addedLines lowering:lower];
+}
+
+- (NSArray *)replaceLinesInRange:(NSRange)range withLines:(NSArray *)newLines
+{
+	StatmentTable *table = [[StatmentTable alloc] initWithSymbolTable:self.symbols];
+
+	if([newLines count] > 0)
+	{
+		Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+											 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+		[self.parser resetStats];
+		[self.parser parseSource:[newLines componentsJoinedByString:@"\n"] withLexer:lexer intoTable:table];
+
+#if PIPELINE_STATS_ENABLED
+		struct pipeline_stats lexerStats = lexer.stats;
+		struct pipeline_stats parserStats = self.parser.stats;
+
+		pipelineStatsAdd(&stats, &lexerStats);
+		pipelineStatsAdd(&stats, &parserStats);
+#endif
+	}
+
+	return [self replaceLinesInRange:range withLines:newLines table:table];
+}
+
+- (NSArray *)replaceLinesInRange:(NSRange)range withLines:(NSArray *)newLines lowering:(Statment *(^)(id line))lower
+{
+	StatmentTable *table = [[StatmentTable alloc] initWithSymbolTable:self.symbols];
+	int lineNumber = 1;
+
+	for(id line in newLines)
+	{
+		Statment *statment = lower(line);
+		statment.lineNumber = lineNumber++;
+
+		[table addStatment:statment];
+	}
+
+	return [self replaceLinesInRange:range withLines:newLines table:table];
+}
+
+- (NSArray *)replaceLinesInRange:(NSRange)range withLines:(NSArray *)newLines table:(StatmentTable *)table
+{
+	NSUInteger addedLines = [newLines count];
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatmentTable:table];
+
+#if PIPELINE_STATS_ENABLED
+	struct pipeline_stats assemblerStats = assembler.stats;
+
+	pipelineStatsAdd(&stats, &assemblerStats);
+	stats.runs++;
+#endif
+
+	NSUInteger oldStart = lineOffsets[range.location];
+	NSUInteger oldLength = lineOffsets[NSMaxRange(range)] - oldStart;
+	NSUInteger newLength = assembler.wordCount;
+	NSInteger delta = (NSInteger) newLength - (NSInteger) oldLength;
+	NSUInteger oldWordCount = wordCount;
+
+	[self spliceWords:assembler.words count:newLength at:oldStart replacing:oldLength];
+	[self spliceLineOffsetsInRange:range withLines:addedLines fromTable:table assembler:assembler at:oldStart delta:delta];
+	[self spliceLineLabelsInRange:range withLines:addedLines fromTable:table];
+	BOOL labelsMoved = [self updateSymbolLinesInRange:range withLines:addedLines fromTable:table] || delta != 0;
+	[self spliceFixups:assembler at:oldStart replacing:oldLength delta:delta];
+
+	[self.lines replaceObjectsInRange:range withObjectsFromArray:newLines];
+
+	NSMutableArray *changed = [[NSMutableArray alloc] init];
+	NSUInteger changedEnd = delta == 0 ? oldStart + newLength : MAX(wordCount, oldWordCount);
+
+	if(changedEnd > oldStart)
+	{
+		[changed addObject:[NSValue valueWithRange:NSMakeRange(oldStart, changedEnd - oldStart)]];
+	}
+
+	[self patchFixupsReportingChangesTo:changed excludingFrom:oldStart to:changedEnd all:labelsMoved];
+
+	return [self coalescedRanges:changed];
+}
+
+// Patched label words are found in fixup order, around the re-encoded span, so the
+// ranges are sorted and merged where they touch before they are handed out.
+- (NSArray *)coalescedRanges:(NSArray *)ranges
+{
+	NSArray *sorted = [ranges sortedArrayUsingComparator:^NSComparisonResult(NSValue *first, NSValue *second)
+	{
+		NSUInteger a = [first rangeValue].location;
+		NSUInteger b = [second rangeValue].location;
+
+		return a < b ? NSOrderedAscending : (a > b ? NSOrderedDescending : NSOrderedSame);
+	}];
+
+	NSMutableArray *coalesced = [[NSMutableArray alloc] initWithCapacity:[sorted count]];
+	NSRange run = NSMakeRange(NSNotFound, 0);
+
+	for(NSValue *value in sorted)
+	{
+		NSRange range = [value rangeValue];
+
+		if(run.location != NSNotFound && range.location <= NSMaxRange(run))
+		{
+			run.length = MAX(NSMaxRange(run), NSMaxRange(range)) - run.location;
+			continue;
+		}
+
+		if(run.location != NSNotFound)
+		{
+			[coalesced addObject:[NSValue valueWithRange:run]];
+		}
+
+		run = range;
+	}
+
+	if(run.location != NSNotFound)
+	{
+		[coalesced addObject:[NSValue valueWithRange:run]];
+	}
+
+	return coalesced;
+}
+
+- (void)spliceWords:(const uint16_t *)newWords count:(NSUInteger)newLength at:(NSUInteger)start replacing:(NSUInteger)oldLength
+{
+	NSUInteger newWordCount = wordCount - oldLength + newLength;
+
+	if(newWordCount > wordCapacity)
+	{
+		wordCapacity = MAX(newWordCount, wordCapacity * 2);
+		buffer = realloc(buffer, wordCapacity * sizeof(uint16_t));
+	}
+
+	if(newLength != oldLength)
+	{
+		memmove(buffer + start + newLength, buffer + start + oldLength, (wordCount - start - oldLength) * sizeof(uint16_t));
+	}
+
+	memcpy(buffer + start, newWords, newLength * sizeof(uint16_t));
+	wordCount = newWordCount;
+}
+
+- (void)spliceLineOffsetsInRange:(NSRange)range
+					   withLines:(NSUInteger)addedLines
+					   fromTable:(StatmentTable *)table
+					   assembler:(Assembler *)assembler
+							  at:(NSUInteger)start
+						   delta:(NSInteger)delta
+{
+	NSUInteger oldLineCount = [self.lines count];
+	NSUInteger newLineCount = oldLineCount - range.length + addedLines;
+
+	if(newLineCount + 1 > lineCapacity)
+	{
+		lineCapacity = MAX(newLineCount + 1, lineCapacity * 2);
+		lineOffsets = realloc(lineOffsets, lineCapacity * sizeof(uint32_t));
+		lineLabels = realloc(lineLabels, lineCapacity * sizeof(int32_t));
+	}
+
+	NSUInteger tail = NSMaxRange(range);
+
+	if(addedLines != range.length)
+	{
+		memmove(lineOffsets + range.location + addedLines, lineOffsets + tail, (oldLineCount - tail + 1) * sizeof(uint32_t));
+	}
+
+	if(delta != 0)
+	{
+		for(NSUInteger line = range.location + addedLines; line <= newLineCount; line++)
+		{
+			lineOffsets[line] = (uint32_t) ((NSInteger) lineOffsets[line] + delta);
+		}
+	}
+
+	NSUInteger row = 0;
+
+	for(NSUInteger line = 0; line < addedLines; line++)
+	{
+		while(row < table.count && (NSUInteger) (table.lineNumbers[row] - 1) < line)
+		{
+			row++;
+		}
+
+		NSUInteger offset = row < table.count ? assembler.rowOffsets[row] : assembler.wordCount;
+		lineOffsets[range.location + line] = (uint32_t) (start + offset);
+	}
+}
+
+// Called after spliceLineOffsetsInRange:, which grows the per-line arrays.
+- (void)spliceLineLabelsInRange:(NSRange)range withLines:(NSUInteger)addedLines fromTable:(StatmentTable *)table
+{
+	NSUInteger tail = NSMaxRange(range);
+
+	if(addedLines != range.length)
+	{
+		memmove(lineLabels + range.location + addedLines, lineLabels + tail, ([self.lines count] - tail) * sizeof(int32_t));
+	}
+
+	for(NSUInteger line = 0; line < addedLines; line++)
+	{
+		lineLabels[range.location + line] = NO_SYMBOL;
+	}
+
+	for(NSUInteger row = 0; row < table.count; row++)
+	{
+		if(table.labels[row] != NO_SYMBOL)
+		{
+			lineLabels[range.location + table.lineNumbers[row] - 1] = table.labels[row];
+		}
+	}
+}
+
+// A label defined on more than one line resolves to its last definition, as in a full
+// assembly. Every symbol whose definition was replaced is looked up again over all the
+// lines, so removing one duplicate falls back to the definition that is left.
+- (BOOL)updateSymbolLinesInRange:(NSRange)range withLines:(NSUInteger)addedLines fromTable:(StatmentTable *)table
+{
+	BOOL changed = NO;
+	NSUInteger oldSymbolCount = symbolCapacity;
+
+	if(self.symbols.count > symbolCapacity)
+	{
+		symbolCapacity = MAX(self.symbols.count, symbolCapacity * 2);
+		symbolLines = realloc(symbolLines, symbolCapacity * sizeof(int32_t));
+
+		for(NSUInteger symbol = oldSymbolCount; symbol < symbolCapacity; symbol++)
+		{
+			symbolLines[symbol] = UNDEFINED_SYMBOL_LINE;
+		}
+	}
+
+	NSInteger lineDelta = (NSInteger) addedLines - (NSInteger) range.length;
+	uint8_t *resolve = calloc(MAX(self.symbols.count, 1), sizeof(uint8_t));
+
+	for(NSUInteger symbol = 0; symbol < self.symbols.count; symbol++)
+	{
+		int32_t line = symbolLines[symbol];
+
+		if(line == UNDEFINED_SYMBOL_LINE || (NSUInteger) line < range.location)
+		{
+			continue;
+		}
+
+		if((NSUInteger) line < NSMaxRange(range))
+		{
+			resolve[symbol] = YES;
+			changed = YES;
+		}
+		else
+		{
+			symbolLines[symbol] = (int32_t) (line + lineDelta);
+		}
+	}
+
+	for(NSUInteger row = 0; row < table.count; row++)
+	{
+		if(table.labels[row] != NO_SYMBOL)
+		{
+			resolve[table.labels[row]] = YES;
+			changed = YES;
+		}
+	}
+
+	if(changed)
+	{
+		NSUInteger newLineCount = [self.lines count] - range.length + addedLines;
+
+		for(NSUInteger symbol = 0; symbol < self.symbols.count; symbol++)
+		{
+			if(resolve[symbol])
+			{
+				symbolLines[symbol] = UNDEFINED_SYMBOL_LINE;
+			}
+		}
+
+		for(NSUInteger line = 0; line < newLineCount; line++)
+		{
+			int32_t label = lineLabels[line];
+
+			if(label != NO_SYMBOL && resolve[label])
+			{
+				symbolLines[label] = (int32_t) line;
+			}
+		}
+	}
+
+	free(resolve);
+
+	return changed;
+}
+
+- (void)spliceFixups:(Assembler *)assembler at:(NSUInteger)start replacing:(NSUInteger)oldLength delta:(NSInteger)delta
+{
+	NSUInteger end = start + oldLength;
+	NSUInteger first = 0;
+
+	while(first < fixupCount && fixups[first].offset < start)
+	{
+		first++;
+	}
+
+	NSUInteger last = first;
+
+	while(last < fixupCount && fixups[last].offset < end)
+	{
+		last++;
+	}
+
+	NSUInteger newFixupCount = fixupCount - (last - first) + assembler.fixupCount;
+
+	if(newFixupCount > fixupCapacity)
+	{
+		fixupCapacity = MAX(newFixupCount, fixupCapacity * 2);
+		fixups = realloc(fixups, fixupCapacity * sizeof(struct label_fixup));
+	}
+
+	memmove(fixups + first + assembler.fixupCount, fixups + last, (fixupCount - last) * sizeof(struct label_fixup));
+
+	for(NSUInteger i = 0; i < assembler.fixupCount; i++)
+	{
+		fixups[first + i].offset = (uint32_t) (start + assembler.fixups[i].offset);
+		fixups[first + i].symbol = assembler.fixups[i].symbol;
+	}
+
+	if(delta != 0)
+	{
+		for(NSUInteger i = first + assembler.fixupCount; i < newFixupCount; i++)
+		{
+			fixups[i].offset = (uint32_t) ((NSInteger) fixups[i].offset + delta);
+		}
+	}
+
+	fixupCount = newFixupCount;
+}
+
+// Label words inside the re-encoded span are always rewritten; the rest of the image
+// only needs them when a label was added, removed or moved.
+- (void)patchFixupsReportingChangesTo:(NSMutableArray *)changed
+						excludingFrom:(NSUInteger)start
+								   to:(NSUInteger)end
+								  all:(BOOL)all
+{
+	NSUInteger runStart = NSNotFound;
+	NSUInteger runEnd = NSNotFound;
+
+	for(NSUInteger i = 0; i < fixupCount; i++)
+	{
+		NSUInteger offset = fixups[i].offset;
+		BOOL inside = offset >= start && offset < end;
+
+		if(!all && !inside)
+		{
+			continue;
+		}
+
+		int32_t line = symbolLines[fixups[i].symbol];
+		uint16_t address = line == UNDEFINED_SYMBOL_LINE ? 0 : (uint16_t) lineOffsets[line];
+
+		if(buffer[offset] == address)
+		{
+			continue;
+		}
+
+		buffer[offset] = address;
+
+		if(inside)
+		{
+			continue;
+		}
+
+		if(offset == runEnd)
+		{
+			runEnd++;
+			continue;
+		}
+
+		if(runStart != NSNotFound)
+		{
+			[changed addObject:[NSValue valueWithRange:NSMakeRange(runStart, runEnd - runStart)]];
+		}
+
+		runStart = offset;
+		runEnd = offset + 1;
+	}
+
+	if(runStart != NSNotFound)
+	{
+		[changed addObject:[NSValue valueWithRange:NSMakeRange(runStart, runEnd - runStart)]];
+	}
+}
+
+@end
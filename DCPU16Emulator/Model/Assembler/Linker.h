@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class ObjectFile;
+
+// Lays object files out back to back from a base address, resolves imports against
+// the symbols the other objects define and applies every relocation. Objects are not
+// modified, so one assembled library can be linked into many programs at once by
+// separate linkers.
+@interface Linker : NSObject
+
+@property(nonatomic, strong, readonly) NSArray *objects;
+
+- (void)addObject:(ObjectFile *)object;
+
+// Throws on a symbol defined by two objects, an import nobody defines, or an image
+// that runs past the end of memory.
+- (NSData *)linkAtBaseAddress:(uint16_t)baseAddress;
+
+// Absolute address of an exported label in the last link, or UNDEFINED_LABEL.
+- (int)addressOfLabel:(NSString *)name;
+
+- (NSUInteger)baseAddressOfObjectAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "Linker.h"
+#import "ObjectFile.h"
+#import "Memory.h"
+
+@interface Linker ()
+
+@property(nonatomic, strong) NSMutableArray *objectList;
+@property(nonatomic, strong) NSMutableDictionary *exports;
+@property(nonatomic, strong) NSMutableArray *objectBases;
+
+@end
+
+@implementation Linker
+
+@synthesize objectList;
+@synthesize exports;
+@synthesize objectBases;
+
+- (id)init
+{
+	self = [super init];
+
+	self.objectList = [[NSMutableArray alloc] init];
+
+	return self;
+}
+
+- (NSArray *)objects
+{
+	return self.objectList;
+}
+
+- (void)addObject:(ObjectFile *)object
+{
+	[self.objectList addObject:object];
+}
+
+- (NSData *)linkAtBaseAddress:(uint16_t)baseAddress
+{
+	[self layoutObjectsFromBaseAddress:baseAddress];
+	[self collectExports];
+
+	NSUInteger totalWords = 0;
+
+	for(ObjectFile *object in self.objectList)
+	{
+		totalWords += object.wordCount;
+	}
+
+	NSMutableData *image = [NSMutableData dataWithLength:totalWords * sizeof(uint16_t)];
+	uint16_t *output = [image mutableBytes];
+
+	for(NSUInteger index = 0; index < [self.objectList count]; index++)
+	{
+		ObjectFile *object = [self.objectList objectAtIndex:index];
+		NSUInteger offset = [self baseAddressOfObjectAtIndex:index] - baseAddress;
+
+		memcpy(output + offset, object.words, object.wordCount * sizeof(uint16_t));
+		[self relocateObject:object atIndex:index into:output + offset];
+	}
+
+	return image;
+}
+
+- (void)layoutObjectsFromBaseAddress:(uint16_t)baseAddress
+{
+	self.objectBases = [NSMutableArray arrayWithCapacity:[self.objectList count]];
+	NSUInteger address = baseAddress;
+
+	for(ObjectFile *object in self.objectList)
+	{
+		[self.objectBases addObject:[NSNumber numberWithUnsignedInteger:address]];
+		address += object.wordCount;
+	}
+
+	if(address > MEMORY_SIZE)
+	{
+		@throw [NSString stringWithFormat:@"Linked image ends at 0x%X, past the end of memory", (unsigned) address];
+	}
+}
+
+- (void)collectExports
+{
+	self.exports = [NSMutableDictionary dictionary];
+
+	for(NSUInteger index = 0; index < [self.objectList count]; index++)
+	{
+		ObjectFile *object = [self.objectList objectAtIndex:index];
+		NSUInteger base = [self baseAddressOfObjectAtIndex:index];
+
+		for(int symbol = 0; symbol < (int) object.symbolCount; symbol++)
+		{
+			int address = [object addressOfSymbol:symbol];
+
+			if(address == UNDEFINED_LABEL)
+			{
+				continue;
+			}
+
+			NSString *name = [object nameOfSymbol:symbol];
+
+			if([self.exports objectForKey:name] != nil)
+			{
+				@throw [NSString stringWithFormat:@"Duplicate symbol %@", name];
+			}
+
+			[self.exports setObject:[NSNumber numberWithUnsignedInteger:base + (NSUInteger) address] forKey:name];
+		}
+	}
+}
+
+// Resolves each symbol of the object once, so relocations are plain array lookups.
+- (void)relocateObject:(ObjectFile *)object atIndex:(NSUInteger)index into:(uint16_t *)output
+{
+	NSUInteger base = [self baseAddressOfObjectAtIndex:index];
+	uint16_t *resolved = malloc(MAX(object.symbolCount, 1) * sizeof(uint16_t));
+
+	for(int symbol = 0; symbol < (int) object.symbolCount; symbol++)
+	{
+		int address = [object addressOfSymbol:symbol];
+
+		if(address != UNDEFINED_LABEL)
+		{
+			resolved[symbol] = (uint16_t) (base + (NSUInteger) address);
+			continue;
+		}
+
+		NSString *name = [object nameOfSymbol:symbol];
+		NSNumber *export = [self.exports objectForKey:name];
+
+		if(export == nil)
+		{
+			free(resolved);
+			@throw [NSString stringWithFormat:@"Undefined symbol %@", name];
+		}
+
+		resolved[symbol] = (uint16_t) [export unsignedIntegerValue];
+	}
+
+	for(NSUInteger i = 0; i < object.relocationCount; i++)
+	{
+		output[object.relocations[i].offset] = resolved[object.relocations[i].symbol];
+	}
+
+	free(resolved);
+}
+
+- (NSUInteger)baseAddressOfObjectAtIndex:(NSUInteger)index
+{
+	return [[self.objectBases objectAtIndex:index] unsignedIntegerValue];
+}
+
+- (int)addressOfLabel:(NSString *)name
+{
+	NSNumber *address = [self.exports objectForKey:name];
+
+	return address != nil ? [address intValue] : UNDEFINED_LABEL;
+}
+
+@end
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "Assembler.h"
+
+@class SymbolTable;
+
+// Relocatable output of one separately assembled source: its words as if loaded at
+// address 0, every symbol it defines or refers to, and a relocation per label operand.
+// A relocation against a defined symbol adds the load address to the word; one against
+// an undefined symbol is an import the Linker fills in from another object.
+@interface ObjectFile : NSObject
+
+@property(nonatomic, readonly) const uint16_t *words;
+@property(nonatomic, readonly) NSUInteger wordCount;
+
+@property(nonatomic, readonly) NSUInteger symbolCount;
+
+@property(nonatomic, readonly) const struct label_fixup *relocations;
+@property(nonatomic, readonly) NSUInteger relocationCount;
+
+// Label operands must keep their next word to be relocatable, so the assembler
+// must not have relaxed any of them.
+- (id)initWithAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols;
+
+// Reads the layout written by data.
+- (id)initWithData:(NSData *)data;
+
+- (NSString *)nameOfSymbol:(int)symbol;
+
+// Offset of the symbol within this object, or UNDEFINED_LABEL for an import.
+- (int)addressOfSymbol:(int)symbol;
+
+- (NSData *)data;
+
+@end
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "ObjectFile.h"
+#import "SymbolTable.h"
+
+#define OBJECT_FILE_MAGIC 0x4A424F44
+#define OBJECT_FILE_VERSION 1
+
+struct object_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t wordCount;
+	uint32_t symbolCount;
+	uint32_t relocationCount;
+	uint32_t namesLength;
+};
+
+@interface ObjectFile ()
+
+@property(nonatomic, strong) NSArray *symbolNames;
+
+@end
+
+@implementation ObjectFile
+{
+	uint16_t *words;
+	int32_t *addresses;
+	struct label_fixup *relocations;
+}
+
+@synthesize wordCount;
+@synthesize relocationCount;
+@synthesize symbolNames;
+
+- (void)dealloc
+{
+	free(words);
+	free(addresses);
+	free(relocations);
+}
+
+- (id)initWithAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols
+{
+	self = [super init];
+
+	if(assembler.relaxedReferenceCount > 0)
+	{
+		@throw @"Relaxed label references can not be relocated";
+	}
+
+	wordCount = assembler.wordCount;
+	words = malloc(MAX(wordCount, 1) * sizeof(uint16_t));
+	memcpy(words, assembler.words, wordCount * sizeof(uint16_t));
+
+	relocationCount = assembler.fixupCount;
+	relocations = malloc(MAX(relocationCount, 1) * sizeof(struct label_fixup));
+	memcpy(relocations, assembler.fixups, relocationCount * sizeof(struct label_fixup));
+
+	NSMutableArray *names = [NSMutableArray arrayWithCapacity:symbols.count];
+	addresses = malloc(MAX(symbols.count, 1) * sizeof(int32_t));
+
+	for(NSUInteger symbol = 0; symbol < symbols.count; symbol++)
+	{
+		[names addObject:[symbols nameForSymbol:(int) symbol]];
+		addresses[symbol] = [assembler addressOfSymbol:(int) symbol];
+	}
+
+	self.symbolNames = names;
+
+	return self;
+}
+
+- (id)initWithData:(NSData *)data
+{
+	self = [super init];
+
+	struct object_header header;
+
+	if([data length] < sizeof(header))
+	{
+		@throw @"Truncated object file";
+	}
+
+	[data getBytes:&header length:sizeof(header)];
+
+	if(header.magic != OBJECT_FILE_MAGIC || header.version != OBJECT_FILE_VERSION)
+	{
+		@throw @"Not an object file";
+	}
+
+	// Sized in 64 bits so huge counts in a corrupt header cannot wrap around.
+	uint64_t length = sizeof(header)
+			+ (uint64_t) header.wordCount * sizeof(uint16_t)
+			+ (uint64_t) header.symbolCount * 2 * sizeof(int32_t)
+			+ header.namesLength
+			+ (uint64_t) header.relocationCount * sizeof(struct label_fixup);
+
+	if([data length] < length)
+	{
+		@throw @"Truncated object file";
+	}
+
+	const uint8_t *wordBytes = (const uint8_t *) [data bytes] + sizeof(header);
+	const uint8_t *addressBytes = wordBytes + header.wordCount * sizeof(uint16_t);
+	const uint8_t *nameLengthBytes = addressBytes + header.symbolCount * sizeof(int32_t);
+	const uint8_t *nameBytes = nameLengthBytes + header.symbolCount * sizeof(int32_t);
+	const uint8_t *relocationBytes = nameBytes + header.namesLength;
+
+	// Everything is checked before the buffers are allocated, so a corrupt file
+	// throws without leaking them.
+	NSMutableArray *names = [NSMutableArray arrayWithCapacity:header.symbolCount];
+	NSUInteger namesRemaining = header.namesLength;
+
+	for(NSUInteger symbol = 0; symbol < header.symbolCount; symbol++)
+	{
+		int32_t nameLength;
+		memcpy(&nameLength, nameLengthBytes + symbol * sizeof(int32_t), sizeof(nameLength));
+
+		NSString *name = nil;
+
+		if(nameLength >= 0 && (NSUInteger) nameLength <= namesRemaining)
+		{
+			name = [[NSString alloc] initWithBytes:nameBytes length:(NSUInteger) nameLength encoding:NSUTF8StringEncoding];
+		}
+
+		if(name == nil)
+		{
+			@throw @"Corrupt object file symbols";
+		}
+
+		[names addObject:name];
+		nameBytes += nameLength;
+		namesRemaining -= (NSUInteger) nameLength;
+	}
+
+	for(NSUInteger i = 0; i < header.relocationCount; i++)
+	{
+		struct label_fixup relocation;
+		memcpy(&relocation, relocationBytes + i * sizeof(struct label_fixup), sizeof(relocation));
+
+		if(relocation.offset >= header.wordCount || relocation.symbol < 0 || (uint32_t) relocation.symbol >= header.symbolCount)
+		{
+			@throw @"Corrupt object file relocations";
+		}
+	}
+
+	wordCount = header.wordCount;
+	words = malloc(MAX(wordCount, 1) * sizeof(uint16_t));
+	memcpy(words, wordBytes, wordCount * sizeof(uint16_t));
+
+	addresses = malloc(MAX(header.symbolCount, 1) * sizeof(int32_t));
+	memcpy(addresses, addressBytes, header.symbolCount * sizeof(int32_t));
+
+	relocationCount = header.relocationCount;
+	relocations = malloc(MAX(relocationCount, 1) * sizeof(struct label_fixup));
+	memcpy(relocations, relocationBytes, relocationCount * sizeof(struct label_fixup));
+
+	self.symbolNames = names;
+
+	return self;
+}
+
+- (const uint16_t *)words
+{
+	return words;
+}
+
+- (const struct label_fixup *)relocations
+{
+	return relocations;
+}
+
+- (NSUInteger)symbolCount
+{
+	return [self.symbolNames count];
+}
+
+- (NSString *)nameOfSymbol:(int)symbol
+{
+	return [self.symbolNames objectAtIndex:(NSUInteger) symbol];
+}
+
+- (int)addressOfSymbol:(int)symbol
+{
+	return addresses[symbol];
+}
+
+// Header, words, symbol addresses, symbol name lengths, name bytes, relocations,
+// all in host byte order.
+- (NSData *)data
+{
+	NSMutableData *nameBytes = [NSMutableData data];
+	NSMutableData *nameLengths = [NSMutableData data];
+
+	for(NSString *name in self.symbolNames)
+	{
+		NSData *utf8 = [name dataUsingEncoding:NSUTF8StringEncoding];
+		int32_t length = (int32_t) [utf8 length];
+
+		[nameBytes appendData:utf8];
+		[nameLengths appendBytes:&length length:sizeof(length)];
+	}
+
+	struct object_header header;
+	header.magic = OBJECT_FILE_MAGIC;
+	header.version = OBJECT_FILE_VERSION;
+	header.wordCount = (uint32_t) wordCount;
+	header.symbolCount = (uint32_t) self.symbolCount;
+	header.relocationCount = (uint32_t) relocationCount;
+	header.namesLength = (uint32_t) [nameBytes length];
+
+	NSMutableData *data = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+	[data appendBytes:words length:wordCount * sizeof(uint16_t)];
+	[data appendBytes:addresses length:self.symbolCount * sizeof(int32_t)];
+	[data appendData:nameLengths];
+	[data appendData:nameBytes];
+	[data appendBytes:relocations length:relocationCount * sizeof(struct label_fixup)];
+
+	return data;
+}
+
+@end
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+enum peephole_rule
+{
+	PEEPHOLE_STRENGTH_REDUCTION,
+	PEEPHOLE_NO_OP_REMOVAL,
+	PEEPHOLE_JUMP_THREADING,
+	PEEPHOLE_UNREACHABLE_CODE,
+	PEEPHOLE_RULE_COUNT,
+};
+
+// Static savings of a rule, counting every rewritten statment as executed once.
+struct peephole_savings
+{
+	NSUInteger applications;
+	NSUInteger cycles;
+	NSUInteger words;
+};
+
+// Optional pass over parsed statments before they reach the Assembler. Turns MUL and
+// DIV by a power of two into shifts, drops moves and logic ops that change nothing,
+// retargets jumps that land on another jump and removes unlabelled code after an
+// unconditional jump. Statments that change are copied, so the input is untouched.
+@interface PeepholeOptimizer : NSObject
+
++ (NSString *)nameOfRule:(enum peephole_rule)rule;
+
+- (NSArray *)optimizeStatments:(NSArray *)statments;
+
+// Savings of the last optimizeStatments: call.
+- (struct peephole_savings)savingsForRule:(enum peephole_rule)rule;
+
+- (NSUInteger)totalCyclesSaved;
+
+// One "rule: applications, cycles, words" line per rule.
+- (NSString *)report;
+
+@end
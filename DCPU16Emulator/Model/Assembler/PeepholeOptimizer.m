@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "PeepholeOptimizer.h"
+#import "Statment.h"
+#import "Operand.h"
+#import "CycleCost.h"
+
+@implementation PeepholeOptimizer
+{
+	struct peephole_savings savings[PEEPHOLE_RULE_COUNT];
+}
+
++ (NSString *)nameOfRule:(enum peephole_rule)rule
+{
+	switch(rule)
+	{
+		case PEEPHOLE_STRENGTH_REDUCTION:
+			return @"strength reduction";
+		case PEEPHOLE_NO_OP_REMOVAL:
+			return @"no-op removal";
+		case PEEPHOLE_JUMP_THREADING:
+			return @"jump threading";
+		case PEEPHOLE_UNREACHABLE_CODE:
+			return @"unreachable code";
+		default:
+			return nil;
+	}
+}
+
+- (struct peephole_savings)savingsForRule:(enum peephole_rule)rule
+{
+	return savings[rule];
+}
+
+- (NSUInteger)totalCyclesSaved
+{
+	NSUInteger cycles = 0;
+
+	for(int rule = 0; rule < PEEPHOLE_RULE_COUNT; rule++)
+	{
+		cycles += savings[rule].cycles;
+	}
+
+	return cycles;
+}
+
+- (NSString *)report
+{
+	NSMutableString *report = [NSMutableString string];
+
+	for(int rule = 0; rule < PEEPHOLE_RULE_COUNT; rule++)
+	{
+		[report appendFormat:@"%@: %u applied, %u cycles, %u words\n",
+							 [PeepholeOptimizer nameOfRule:(enum peephole_rule) rule],
+							 (unsigned) savings[rule].applications,
+							 (unsigned) savings[rule].cycles,
+							 (unsigned) savings[rule].words];
+	}
+
+	return report;
+}
+
+- (NSArray *)optimizeStatments:(NSArray *)statments
+{
+	memset(savings, 0, sizeof(savings));
+
+	NSMutableArray *result = [statments mutableCopy];
+
+	[self reduceStrength:result];
+	[self removeNoOps:result];
+	[self threadJumps:result];
+	[self removeUnreachableCode:result];
+
+	return result;
+}
+
+- (void)recordRule:(enum peephole_rule)rule cycles:(NSInteger)cycles words:(NSInteger)words
+{
+	savings[rule].applications++;
+	savings[rule].cycles += (NSUInteger) MAX(cycles, 0);
+	savings[rule].words += (NSUInteger) MAX(words, 0);
+}
+
+#pragma mark - Statment shape
+
+static BOOL isLiteral(Operand *operand, uint16_t value)
+{
+	return [operand operandType] == O_NEXT_WORD && [operand.label length] == 0 && operand.nextWord == value;
+}
+
+static NSUInteger wordsOfOperand(Operand *operand)
+{
+	// Same rule as Assembler assembleOperandNextWord: unlabelled values up to
+	// OPERAND_LITERAL_MAX are not written out for any of the next word kinds.
+	switch([operand operandType])
+	{
+		case O_NEXT_WORD:
+		case O_INDIRECT_NEXT_WORD:
+		case O_INDIRECT_NEXT_WORD_OFFSET:
+			return [operand.label length] > 0 || operand.nextWord > OPERAND_LITERAL_MAX ? 1 : 0;
+		default:
+			return 0;
+	}
+}
+
+static NSUInteger wordsOfStatment(Statment *statment)
+{
+	if(statment.isData)
+	{
+		return [statment.dat length] / sizeof(uint16_t) + [statment.binaryInclude length] / sizeof(uint16_t);
+	}
+
+	return 1 + wordsOfOperand(statment.firstOperand) + wordsOfOperand(statment.secondOperand);
+}
+
+static NSUInteger cyclesOfStatment(Statment *statment)
+{
+	NSUInteger cycles = (wordsOfOperand(statment.firstOperand) + wordsOfOperand(statment.secondOperand)) * NEXT_WORD_CYCLES;
+
+	if(statment.opcode == 0)
+	{
+		return cycles + (NSUInteger) cyclesForNonBasicOpcode(statment.opcodeNonBasic);
+	}
+
+	return cycles + (NSUInteger) cyclesForBasicOpcode(statment.opcode);
+}
+
+static BOOL isConditional(Statment *statment)
+{
+	return statment.opcode >= OP_IFE && statment.opcode <= OP_IFB;
+}
+
+static BOOL isUnconditionalJump(NSArray *statments, NSUInteger index)
+{
+	Statment *statment = [statments objectAtIndex:index];
+
+	if(statment.opcode != OP_SET || [statment.firstOperand operandType] != O_PC)
+	{
+		return NO;
+	}
+
+	return index == 0 || !isConditional([statments objectAtIndex:index - 1]);
+}
+
+static NSString *jumpTarget(Statment *statment)
+{
+	BOOL jumps = (statment.opcode == OP_SET && [statment.firstOperand operandType] == O_PC) ||
+			(statment.opcode == 0 && statment.opcodeNonBasic == OP_JSR);
+	Operand *target = statment.opcode == OP_SET ? statment.secondOperand : statment.firstOperand;
+
+	if(!jumps || [target operandType] != O_NEXT_WORD || [target.label length] == 0)
+	{
+		return nil;
+	}
+
+	return target.label;
+}
+
+static BOOL hasSideEffects(Operand *operand)
+{
+	enum operand_type type = [operand operandType];
+
+	return type == O_POP || type == O_PUSH;
+}
+
+static BOOL isSameLocation(Operand *first, Operand *second)
+{
+	enum operand_type type = [first operandType];
+
+	if(type != [second operandType])
+	{
+		return NO;
+	}
+
+	switch(type)
+	{
+		case O_REG:
+		case O_INDIRECT_REG:
+			return first.registerValue == second.registerValue;
+		case O_SP:
+		case O_O:
+		case O_PEEK:
+			return YES;
+		default:
+			return NO;
+	}
+}
+
+static BOOL isNoOp(Statment *statment)
+{
+	if(statment.isData || hasSideEffects(statment.firstOperand))
+	{
+		return NO;
+	}
+
+	switch(statment.opcode)
+	{
+		case OP_SET:
+			return isSameLocation(statment.firstOperand, statment.secondOperand);
+		case OP_BOR:
+		case OP_XOR:
+			return isLiteral(statment.secondOperand, 0);
+		case OP_AND:
+			return isLiteral(statment.secondOperand, 0xFFFF);
+		default:
+			return NO;
+	}
+}
+
+- (Statment *)copyOfStatment:(Statment *)statment
+{
+	Statment *copy = [[Statment alloc] init];
+
+	copy.label = statment.label;
+	copy.lineNumber = statment.lineNumber;
+	copy.menemonic = statment.menemonic;
+	copy.firstOperand = statment.firstOperand;
+	copy.secondOperand = statment.secondOperand;
+	copy.binaryInclude = statment.binaryInclude;
+
+	const UInt16 *words = [statment.dat bytes];
+
+	for(NSUInteger i = 0; i < [statment.dat length] / sizeof(UInt16); i++)
+	{
+		[copy addDat:words[i]];
+	}
+
+	return copy;
+}
+
+#pragma mark - Rules
+
+// MUL and DIV set O exactly like SHL and SHR by the matching power, so only the
+// operation cost and possibly the literal's next word change.
+- (void)reduceStrength:(NSMutableArray *)statments
+{
+	for(NSUInteger i = 0; i < [statments count]; i++)
+	{
+		Statment *statment = [statments objectAtIndex:i];
+		Operand *factor = statment.secondOperand;
+
+		if((statment.opcode != OP_MUL && statment.opcode != OP_DIV) || [factor operandType] != O_NEXT_WORD || [factor.label length] > 0)
+		{
+			continue;
+		}
+
+		uint16_t value = factor.nextWord;
+
+		if(value == 0 || (value & (value - 1)) != 0)
+		{
+			continue;
+		}
+
+		Operand *shift = [Operand newOperand:O_NEXT_WORD];
+		shift.nextWord = (uint16_t) __builtin_ctz(value);
+
+		Statment *reduced = [self copyOfStatment:statment];
+		reduced.menemonic = statment.opcode == OP_MUL ? @"SHL" : @"SHR";
+		reduced.secondOperand = shift;
+
+		[self recordRule:PEEPHOLE_STRENGTH_REDUCTION
+				  cycles:(NSInteger) cyclesOfStatment(statment) - (NSInteger) cyclesOfStatment(reduced)
+				   words:(NSInteger) wordsOfStatment(statment) - (NSInteger) wordsOfStatment(reduced)];
+
+		[statments replaceObjectAtIndex:i withObject:reduced];
+	}
+}
+
+// A no-op behind a conditional is what the conditional skips, so it stays. A label on a
+// removed statment moves to the next one when that one has none.
+- (void)removeNoOps:(NSMutableArray *)statments
+{
+	NSUInteger i = 0;
+
+	while(i < [statments count])
+	{
+		Statment *statment = [statments objectAtIndex:i];
+
+		if(!isNoOp(statment) || (i > 0 && isConditional([statments objectAtIndex:i - 1])))
+		{
+			i++;
+			continue;
+		}
+
+		if([statment.label length] > 0)
+		{
+			if(i + 1 == [statments count] || [[[statments objectAtIndex:i + 1] label] length] > 0)
+			{
+				i++;
+				continue;
+			}
+
+			Statment *next = [self copyOfStatment:[statments objectAtIndex:i + 1]];
+			next.label = statment.label;
+			[statments replaceObjectAtIndex:i + 1 withObject:next];
+		}
+
+		[self recordRule:PEEPHOLE_NO_OP_REMOVAL cycles:(NSInteger) cyclesOfStatment(statment) words:(NSInteger) wordsOfStatment(statment)];
+		[statments removeObjectAtIndex:i];
+	}
+}
+
+// A jump to a label on another unconditional label jump goes straight to the final
+// target, saving the intermediate jump every time it is taken.
+- (void)threadJumps:(NSMutableArray *)statments
+{
+	NSMutableDictionary *labelRows = [NSMutableDictionary dictionary];
+
+	for(NSUInteger i = 0; i < [statments count]; i++)
+	{
+		NSString *label = [[statments objectAtIndex:i] label];
+
+		if([label length] > 1)
+		{
+			[labelRows setObject:[NSNumber numberWithUnsignedInteger:i] forKey:[label substringFromIndex:1]];
+		}
+	}
+
+	for(NSUInteger i = 0; i < [statments count]; i++)
+	{
+		Statment *statment = [statments objectAtIndex:i];
+		NSString *target = jumpTarget(statment);
+
+		if(target == nil)
+		{
+			continue;
+		}
+
+		NSMutableSet *visited = [NSMutableSet setWithObject:target];
+		NSString *finalTarget = target;
+		NSUInteger cycles = 0;
+		NSNumber *row;
+
+		while((row = [labelRows objectForKey:finalTarget]) != nil)
+		{
+			Statment *landing = [statments objectAtIndex:[row unsignedIntegerValue]];
+			NSString *next = landing.opcode == OP_SET ? jumpTarget(landing) : nil;
+
+			if(next == nil || [visited containsObject:next])
+			{
+				break;
+			}
+
+			[visited addObject:next];
+			cycles += cyclesOfStatment(landing);
+			finalTarget = next;
+		}
+
+		if(finalTarget == target)
+		{
+			continue;
+		}
+
+		Operand *operand = [Operand newOperand:O_NEXT_WORD];
+		operand.label = finalTarget;
+
+		Statment *threaded = [self copyOfStatment:statment];
+
+		if(statment.opcode == OP_SET)
+		{
+			threaded.secondOperand = operand;
+		}
+		else
+		{
+			threaded.firstOperand = operand;
+		}
+
+		[self recordRule:PEEPHOLE_JUMP_THREADING cycles:(NSInteger) cycles words:0];
+		[statments replaceObjectAtIndex:i withObject:threaded];
+	}
+}
+
+// Nothing falls through an unconditional jump, and only a label makes the code after it
+// reachable again. Data is kept since it may be addressed relative to an earlier label.
+- (void)removeUnreachableCode:(NSMutableArray *)statments
+{
+	for(NSUInteger i = 0; i < [statments count]; i++)
+	{
+		if(!isUnconditionalJump(statments, i))
+		{
+			continue;
+		}
+
+		while(i + 1 < [statments count])
+		{
+			Statment *next = [statments objectAtIndex:i + 1];
+
+			if([next.label length] > 0 || next.isData)
+			{
+				break;
+			}
+
+			[self recordRule:PEEPHOLE_UNREACHABLE_CODE cycles:0 words:(NSInteger) wordsOfStatment(next)];
+			[statments removeObjectAtIndex:i + 1];
+		}
+	}
+}
+
+@end
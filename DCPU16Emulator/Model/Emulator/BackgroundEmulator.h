@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "DCPU.h"
+
+#define EMULATOR_COMMAND_CAPACITY 64
+#define EMULATOR_BATCH_SIZE 1024
+
+enum emulator_command_type
+{
+	EMULATOR_RUN,
+	EMULATOR_PAUSE,
+	EMULATOR_STEP,
+	EMULATOR_STOP,
+};
+
+struct emulator_command
+{
+	enum emulator_command_type type;
+	uint32_t count;
+};
+
+struct emulator_state
+{
+	uint32_t sequence;
+	uint16_t registers[NUM_REGISTERS];
+	uint16_t programCounter;
+	uint16_t stackPointer;
+	uint16_t overflow;
+	uint8_t running;
+	uint8_t halted;
+	uint64_t instructionCount;
+};
+
+// Runs a DCPU on its own serial queue. Commands go through a bounded lock-free queue and
+// the emulator publishes its registers and dirty memory pages behind a seqlock, so any
+// number of readers can poll consistent state without ever blocking the emulation loop.
+// The DCPU must not be touched from other threads once the emulator has been created.
+@interface BackgroundEmulator : NSObject
+
+@property(nonatomic, strong, readonly) DCPU *cpu;
+
+- (id)initWithCPU:(DCPU *)cpu;
+
+// Returns NO when the command queue is full.
+- (BOOL)postCommand:(struct emulator_command)command;
+
+- (BOOL)run;
+
+- (BOOL)pause;
+
+- (BOOL)step:(uint32_t)count;
+
+// Ends the emulation loop, which releases the emulator.
+- (BOOL)stop;
+
+- (void)readState:(struct emulator_state *)state;
+
+// Copies every page published after sequence into memory, which holds MEMORY_SIZE words,
+// and returns the sequence the copy is consistent with. Pass 0 for a full copy.
+- (uint32_t)readPagesChangedSince:(uint32_t)sequence intoMemory:(uint16_t *)memory;
+
+@end
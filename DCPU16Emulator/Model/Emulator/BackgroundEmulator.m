@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import <libkern/OSAtomic.h>
+#import "BackgroundEmulator.h"
+
+#define COMMAND_MASK (EMULATOR_COMMAND_CAPACITY - 1)
+
+struct command_slot
+{
+	volatile int32_t sequence;
+	struct emulator_command command;
+};
+
+@interface BackgroundEmulator ()
+{
+	struct command_slot commands[EMULATOR_COMMAND_CAPACITY];
+	volatile int32_t enqueuePosition;
+	int32_t dequeuePosition;
+
+	volatile int32_t seqlock;
+	struct emulator_state published;
+	uint32_t pageSequences[MEMORY_PAGE_COUNT];
+	uint16_t memoryImage[MEMORY_SIZE];
+
+	BOOL running;
+	BOOL halted;
+	BOOL stopped;
+	uint32_t stepsLeft;
+	uint64_t instructionCount;
+
+	dispatch_queue_t q_emulator;
+	dispatch_semaphore_t wake;
+}
+
+@property(nonatomic, strong, readwrite) DCPU *cpu;
+
+@end
+
+@implementation BackgroundEmulator
+
+@synthesize cpu;
+
+- (id)initWithCPU:(DCPU *)theCpu
+{
+	self = [super init];
+
+	self.cpu = theCpu;
+
+	for(int32_t i = 0; i < EMULATOR_COMMAND_CAPACITY; i++)
+	{
+		commands[i].sequence = i;
+	}
+
+	q_emulator = dispatch_queue_create("DCPU16Emulator.emulation", DISPATCH_QUEUE_SERIAL);
+	wake = dispatch_semaphore_create(0);
+
+	[self publish];
+
+	dispatch_async(q_emulator, ^
+	{
+		[self emulationLoop];
+	});
+
+	return self;
+}
+
+- (void)dealloc
+{
+	dispatch_release(q_emulator);
+	dispatch_release(wake);
+}
+
+#pragma mark - Command queue
+
+// Bounded multi-producer queue: a producer claims a position with a compare and swap and
+// hands the slot over by bumping its sequence, the emulation loop is the only consumer.
+- (BOOL)postCommand:(struct emulator_command)command
+{
+	int32_t position = enqueuePosition;
+	struct command_slot *slot;
+
+	for(;;)
+	{
+		slot = &commands[position & COMMAND_MASK];
+		int32_t difference = slot->sequence - position;
+
+		if(difference == 0)
+		{
+			if(OSAtomicCompareAndSwap32Barrier(position, position + 1, &enqueuePosition))
+			{
+				break;
+			}
+		}
+		else if(difference < 0)
+		{
+			return NO;
+		}
+
+		position = enqueuePosition;
+	}
+
+	slot->command = command;
+	OSMemoryBarrier();
+	slot->sequence = position + 1;
+
+	dispatch_semaphore_signal(wake);
+
+	return YES;
+}
+
+- (BOOL)takeCommand:(struct emulator_command *)command
+{
+	struct command_slot *slot = &commands[dequeuePosition & COMMAND_MASK];
+
+	if(slot->sequence - (dequeuePosition + 1) < 0)
+	{
+		return NO;
+	}
+
+	OSMemoryBarrier();
+	*command = slot->command;
+	OSMemoryBarrier();
+	slot->sequence = dequeuePosition + EMULATOR_COMMAND_CAPACITY;
+	dequeuePosition++;
+
+	return YES;
+}
+
+- (BOOL)run
+{
+	struct emulator_command command = {EMULATOR_RUN, 0};
+	return [self postCommand:command];
+}
+
+- (BOOL)pause
+{
+	struct emulator_command command = {EMULATOR_PAUSE, 0};
+	return [self postCommand:command];
+}
+
+- (BOOL)step:(uint32_t)count
+{
+	struct emulator_command command = {EMULATOR_STEP, count};
+	return [self postCommand:command];
+}
+
+- (BOOL)stop
+{
+	struct emulator_command command = {EMULATOR_STOP, 0};
+	return [self postCommand:command];
+}
+
+#pragma mark - Emulation loop
+
+- (void)emulationLoop
+{
+	while(!stopped)
+	{
+		[self takeCommands];
+
+		if(stopped)
+		{
+			break;
+		}
+
+		if(!running && stepsLeft == 0)
+		{
+			dispatch_semaphore_wait(wake, DISPATCH_TIME_FOREVER);
+			continue;
+		}
+
+		[self executeBatch];
+		[self publish];
+	}
+}
+
+- (void)takeCommands
+{
+	struct emulator_command command;
+
+	while([self takeCommand:&command])
+	{
+		switch(command.type)
+		{
+			case EMULATOR_RUN:
+				running = !halted;
+				break;
+			case EMULATOR_PAUSE:
+				running = NO;
+				stepsLeft = 0;
+				[self publish];
+				break;
+			case EMULATOR_STEP:
+				stepsLeft = halted ? 0 : stepsLeft + command.count;
+				break;
+			case EMULATOR_STOP:
+				stopped = YES;
+				break;
+		}
+	}
+}
+
+- (void)executeBatch
+{
+	uint32_t batch = running ? EMULATOR_BATCH_SIZE : MIN(stepsLeft, (uint32_t) EMULATOR_BATCH_SIZE);
+
+	for(uint32_t i = 0; i < batch; i++)
+	{
+		if(![self.cpu executeInstruction])
+		{
+			halted = YES;
+			running = NO;
+			stepsLeft = 0;
+			return;
+		}
+
+		instructionCount++;
+	}
+
+	if(!running)
+	{
+		stepsLeft -= batch;
+	}
+}
+
+#pragma mark - Snapshot
+
+// Only called on the emulation queue, or from init before the loop starts.
+- (void)publish
+{
+	uint32_t dirty[MEMORY_PAGE_MASKS];
+	Memory *memory = self.cpu.memory;
+
+	[memory takeDirtyPages:dirty];
+
+	OSAtomicIncrement32Barrier(&seqlock);
+
+	uint32_t sequence = published.sequence + 1;
+
+	published.sequence = sequence;
+	published.programCounter = (uint16_t) self.cpu.programCounter;
+	published.stackPointer = (uint16_t) self.cpu.stackPointer;
+	published.overflow = (uint16_t) self.cpu.overflow;
+	published.running = (uint8_t) (running || stepsLeft > 0);
+	published.halted = (uint8_t) halted;
+	published.instructionCount = instructionCount;
+
+	for(int reg = 0; reg < NUM_REGISTERS; reg++)
+	{
+		published.registers[reg] = (uint16_t) [self.cpu readGeneralPurposeRegisterValue:reg];
+	}
+
+	for(NSUInteger page = 0; page < MEMORY_PAGE_COUNT; page++)
+	{
+		if((dirty[page / 32] & (1u << (page % 32))) == 0)
+		{
+			continue;
+		}
+
+		NSUInteger start = page * MEMORY_PAGE_WORDS;
+
+		[memory copyWordsInRange:NSMakeRange(start, MEMORY_PAGE_WORDS) into:memoryImage + start];
+
+		pageSequences[page] = sequence;
+	}
+
+	OSAtomicIncrement32Barrier(&seqlock);
+}
+
+- (void)readState:(struct emulator_state *)state
+{
+	int32_t before;
+
+	do
+	{
+		before = seqlock;
+		OSMemoryBarrier();
+		*state = published;
+		OSMemoryBarrier();
+	} while((before & 1) != 0 || seqlock != before);
+}
+
+- (uint32_t)readPagesChangedSince:(uint32_t)sequence intoMemory:(uint16_t *)memory
+{
+	int32_t before;
+	uint32_t current = 0;
+
+	do
+	{
+		before = seqlock;
+		OSMemoryBarrier();
+
+		if((before & 1) != 0)
+		{
+			continue;
+		}
+
+		current = published.sequence;
+
+		for(NSUInteger page = 0; page < MEMORY_PAGE_COUNT; page++)
+		{
+			if(pageSequences[page] > sequence)
+			{
+				memcpy(memory + page * MEMORY_PAGE_WORDS, memoryImage + page * MEMORY_PAGE_WORDS, MEMORY_PAGE_WORDS * sizeof(uint16_t));
+			}
+		}
+
+		OSMemoryBarrier();
+	} while((before & 1) != 0 || seqlock != before);
+
+	return current;
+}
+
+@end
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class Assembler;
+@class SymbolTable;
+
+#define CALL_PROFILER_MAX_DEPTH 1024
+
+// A function is a call target; the entry address stands for everything run outside calls.
+struct function_profile
+{
+	uint16_t address;
+	uint32_t calls;
+	uint64_t inclusiveCycles;
+	uint64_t exclusiveCycles;
+};
+
+// Shadow call stack fed by DCPU after every instruction. JSR pushes its target and
+// SET PC, POP pops, so returns that bypass SET PC, POP are not seen. Cycles follow the
+// spec costs in CycleCost.h. Recursive calls count once toward a function's inclusive
+// cycles. Calls nested deeper than CALL_PROFILER_MAX_DEPTH are charged to the deepest frame.
+@interface CallProfiler : NSObject
+
+// Charge sampleInterval cycles to the running function every sampleInterval cycles
+// instead of charging every instruction. Zero traces exactly.
+@property(nonatomic, assign) NSUInteger sampleInterval;
+
+@property(nonatomic, readonly) uint64_t cycles;
+@property(nonatomic, readonly) NSUInteger depth;
+
+@property(nonatomic, readonly) const struct function_profile *functions;
+@property(nonatomic, readonly) NSUInteger functionCount;
+
+- (id)initWithEntryAddress:(uint16_t)address;
+
+- (void)addLabel:(NSString *)name atAddress:(uint16_t)address;
+
+- (void)addLabelsFromAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols;
+
+- (void)recordInstruction:(uint16_t)instruction skipped:(BOOL)skipped nextProgramCounter:(uint16_t)programCounter;
+
+- (NSString *)nameOfFunctionAtAddress:(uint16_t)address;
+
+// One "entry;caller;callee cycles" line per call path, as flamegraph.pl reads it.
+- (NSString *)foldedStacks;
+
+- (void)reset;
+
+@end
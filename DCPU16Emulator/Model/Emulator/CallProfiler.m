@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "CallProfiler.h"
+#import "Assembler.h"
+#import "SymbolTable.h"
+#import "Statment.h"
+#import "CycleCost.h"
+
+#define CODE_POP 0x18
+#define CODE_PC 0x1C
+
+#define NO_NODE -1
+#define INITIAL_NODE_CAPACITY 64
+
+// One node per distinct call path, children always stored after their parent.
+struct call_node
+{
+	uint16_t address;
+	int32_t parent;
+	int32_t firstChild;
+	int32_t nextSibling;
+	uint32_t calls;
+	uint64_t selfCycles;
+};
+
+@interface CallProfiler ()
+
+@property(nonatomic, strong) NSMutableDictionary *labels;
+
+@end
+
+@implementation CallProfiler
+{
+	uint16_t entryAddress;
+
+	struct call_node *nodes;
+	NSUInteger nodeCount;
+	NSUInteger nodeCapacity;
+	int32_t current;
+
+	// Calls past CALL_PROFILER_MAX_DEPTH that still have to return.
+	NSUInteger overflowDepth;
+	uint64_t nextSample;
+
+	struct function_profile *functions;
+	NSUInteger functionCount;
+	BOOL summarized;
+}
+
+@synthesize sampleInterval;
+@synthesize cycles;
+@synthesize depth;
+@synthesize labels;
+
+- (id)init
+{
+	return [self initWithEntryAddress:0];
+}
+
+- (id)initWithEntryAddress:(uint16_t)address
+{
+	self = [super init];
+
+	entryAddress = address;
+	labels = [[NSMutableDictionary alloc] init];
+
+	[self reset];
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(nodes);
+	free(functions);
+}
+
+- (void)reset
+{
+	nodeCount = 0;
+	depth = 0;
+	overflowDepth = 0;
+	cycles = 0;
+	nextSample = sampleInterval;
+	summarized = NO;
+
+	current = [self childOf:NO_NODE withAddress:entryAddress];
+	nodes[current].calls = 1;
+}
+
+- (void)setSampleInterval:(NSUInteger)interval
+{
+	sampleInterval = interval;
+	nextSample = cycles + interval;
+}
+
+- (int32_t)childOf:(int32_t)parent withAddress:(uint16_t)address
+{
+	if(parent != NO_NODE)
+	{
+		for(int32_t child = nodes[parent].firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+		{
+			if(nodes[child].address == address)
+			{
+				return child;
+			}
+		}
+	}
+
+	if(nodeCount == nodeCapacity)
+	{
+		nodeCapacity = nodeCapacity == 0 ? INITIAL_NODE_CAPACITY : nodeCapacity * 2;
+		nodes = realloc(nodes, nodeCapacity * sizeof(struct call_node));
+	}
+
+	int32_t node = (int32_t) nodeCount++;
+
+	nodes[node].address = address;
+	nodes[node].parent = parent;
+	nodes[node].firstChild = NO_NODE;
+	nodes[node].nextSibling = NO_NODE;
+	nodes[node].calls = 0;
+	nodes[node].selfCycles = 0;
+
+	if(parent != NO_NODE)
+	{
+		nodes[node].nextSibling = nodes[parent].firstChild;
+		nodes[parent].firstChild = node;
+	}
+
+	return node;
+}
+
+- (void)recordInstruction:(uint16_t)instruction skipped:(BOOL)skipped nextProgramCounter:(uint16_t)programCounter
+{
+	int opcode = instruction & 0xF;
+	int a = (instruction >> 4) & 0x3F;
+	int b = (instruction >> 10) & 0x3F;
+	uint64_t cost = (uint64_t) (skipped ? FAILED_TEST_CYCLES : cyclesForInstruction(instruction));
+
+	cycles += cost;
+	summarized = NO;
+
+	if(sampleInterval == 0)
+	{
+		nodes[current].selfCycles += cost;
+	}
+	else
+	{
+		while(cycles >= nextSample)
+		{
+			nodes[current].selfCycles += sampleInterval;
+			nextSample += sampleInterval;
+		}
+	}
+
+	if(skipped)
+	{
+		return;
+	}
+
+	if(opcode == 0 && a == OP_JSR)
+	{
+		if(depth < CALL_PROFILER_MAX_DEPTH)
+		{
+			current = [self childOf:current withAddress:programCounter];
+			nodes[current].calls++;
+			depth++;
+		}
+		else
+		{
+			overflowDepth++;
+		}
+	}
+	else if(opcode == OP_SET && a == CODE_PC && b == CODE_POP)
+	{
+		if(overflowDepth > 0)
+		{
+			overflowDepth--;
+		}
+		else if(depth > 0)
+		{
+			current = nodes[current].parent;
+			depth--;
+		}
+	}
+}
+
+#pragma mark - Reports
+
+- (void)summarize
+{
+	if(summarized)
+	{
+		return;
+	}
+
+	uint64_t *totals = malloc(MAX(nodeCount, 1) * sizeof(uint64_t));
+	int32_t *functionOfNode = malloc(MAX(nodeCount, 1) * sizeof(int32_t));
+
+	for(NSUInteger node = 0; node < nodeCount; node++)
+	{
+		totals[node] = nodes[node].selfCycles;
+	}
+
+	for(NSUInteger node = nodeCount; node-- > 1;)
+	{
+		totals[nodes[node].parent] += totals[node];
+	}
+
+	free(functions);
+	functions = malloc(MAX(nodeCount, 1) * sizeof(struct function_profile));
+	functionCount = 0;
+
+	for(NSUInteger node = 0; node < nodeCount; node++)
+	{
+		int32_t function = NO_NODE;
+
+		for(NSUInteger index = 0; index < functionCount; index++)
+		{
+			if(functions[index].address == nodes[node].address)
+			{
+				function = (int32_t) index;
+				break;
+			}
+		}
+
+		if(function == NO_NODE)
+		{
+			function = (int32_t) functionCount++;
+			functions[function].address = nodes[node].address;
+			functions[function].calls = 0;
+			functions[function].inclusiveCycles = 0;
+			functions[function].exclusiveCycles = 0;
+		}
+
+		functionOfNode[node] = function;
+		functions[function].calls += nodes[node].calls;
+		functions[function].exclusiveCycles += nodes[node].selfCycles;
+
+		BOOL recursive = NO;
+
+		for(int32_t ancestor = nodes[node].parent; ancestor != NO_NODE && !recursive; ancestor = nodes[ancestor].parent)
+		{
+			recursive = functionOfNode[ancestor] == function;
+		}
+
+		if(!recursive)
+		{
+			functions[function].inclusiveCycles += totals[node];
+		}
+	}
+
+	free(totals);
+	free(functionOfNode);
+	summarized = YES;
+}
+
+- (const struct function_profile *)functions
+{
+	[self summarize];
+	return functions;
+}
+
+- (NSUInteger)functionCount
+{
+	[self summarize];
+	return functionCount;
+}
+
+- (void)addLabel:(NSString *)name atAddress:(uint16_t)address
+{
+	[self.labels setObject:name forKey:[NSNumber numberWithUnsignedShort:address]];
+}
+
+- (void)addLabelsFromAssembler:(Assembler *)assembler symbols:(SymbolTable *)symbols
+{
+	for(NSUInteger symbol = 0; symbol < symbols.count; symbol++)
+	{
+		int address = [assembler addressOfSymbol:(int) symbol];
+
+		if(address != UNDEFINED_LABEL)
+		{
+			[self addLabel:[symbols nameForSymbol:(int) symbol] atAddress:(uint16_t) address];
+		}
+	}
+}
+
+- (NSString *)nameOfFunctionAtAddress:(uint16_t)address
+{
+	NSString *name = [self.labels objectForKey:[NSNumber numberWithUnsignedShort:address]];
+
+	return name != nil ? name : [NSString stringWithFormat:@"0x%04X", address];
+}
+
+- (NSString *)foldedStacks
+{
+	NSMutableString *folded = [NSMutableString string];
+	NSMutableArray *path = [NSMutableArray array];
+
+	for(NSUInteger node = 0; node < nodeCount; node++)
+	{
+		if(nodes[node].selfCycles == 0)
+		{
+			continue;
+		}
+
+		[path removeAllObjects];
+
+		for(int32_t frame = (int32_t) node; frame != NO_NODE; frame = nodes[frame].parent)
+		{
+			[path insertObject:[self nameOfFunctionAtAddress:nodes[frame].address] atIndex:0];
+		}
+
+		[folded appendFormat:@"%@ %llu\n", [path componentsJoinedByString:@";"], nodes[node].selfCycles];
+	}
+
+	return folded;
+}
+
+@end
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+// Cycle costs from the DCPU-16 1.1 specification, shared by the static tools that
+// reason about guest time.
+#define NEXT_WORD_CYCLES 1
+#define FAILED_TEST_CYCLES 1
+
+static inline int cyclesForBasicOpcode(int opcode)
+{
+	switch(opcode)
+	{
+		case 0x2: // ADD
+		case 0x3: // SUB
+		case 0x4: // MUL
+		case 0x7: // SHL
+		case 0x8: // SHR
+			return 2;
+		case 0x5: // DIV
+		case 0x6: // MOD
+			return 3;
+		case 0xC: // IFE
+		case 0xD: // IFN
+		case 0xE: // IFG
+		case 0xF: // IFB
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+static inline int cyclesForNonBasicOpcode(int opcode)
+{
+	return 2;
+}
+
+// Operand codes that read the next word: [next word + register], [next word] and next word.
+static inline int cyclesForOperandCode(int code)
+{
+	return (code >= 0x10 && code <= 0x17) || code == 0x1E || code == 0x1F ? NEXT_WORD_CYCLES : 0;
+}
+
+// Whole instruction cost from the word the InstructionBuilder decodes.
+static inline int cyclesForInstruction(uint16_t instruction)
+{
+	int opcode = instruction & 0xF;
+	int a = (instruction >> 4) & 0x3F;
+	int b = (instruction >> 10) & 0x3F;
+
+	if(opcode == 0)
+	{
+		return cyclesForNonBasicOpcode(a) + cyclesForOperandCode(b);
+	}
+
+	return cyclesForBasicOpcode(opcode) + cyclesForOperandCode(a) + cyclesForOperandCode(b);
+}
@@ -23,12 +23,20 @@
 #import "Memory.h"
 #import "DCPUProtocol.h"
 
+@class CallProfiler;
+
 @interface DCPU : NSObject <DCPUProtocol>
 
 @property(nonatomic, strong, readonly) Memory *memory;
 
+// Sees every executed instruction while set.
+@property(nonatomic, strong) CallProfiler *profiler;
+
 - (id)initWithProgram:(NSArray *)program;
 
+// Loads an image of host byte order words, as produced by Assembler image.
+- (id)initWithImage:(NSData *)image;
+
 - (BOOL)executeInstruction;
 
 @end
@@ -24,6 +24,7 @@
 #import "CPUInstruction.h"
 #import "InstructionBuilder.h"
 #import "InstructionOperandFactory.h"
+#import "CallProfiler.h"
 
 @interface DCPU ()
 {
@@ -42,6 +43,7 @@
 @synthesize operandFactory;
 @synthesize instructionBuilder;
 @synthesize ignoreNextInstruction;
+@synthesize profiler;
 
 - (id)initWithProgram:(NSArray *)program
 {
@@ -56,6 +58,19 @@
 	return self;
 }
 
+- (id)initWithImage:(NSData *)image
+{
+	self = [super init];
+
+	self.memory = [[Memory alloc] init];
+	self.operandFactory = [[InstructionOperandFactory alloc] init];
+	self.instructionBuilder = [[InstructionBuilder alloc] initWithInstructionOperandFactory:operandFactory];
+
+	[self.memory loadWords:[image bytes] count:[image length] / sizeof(uint16_t)];
+
+	return self;
+}
+
 - (BOOL)executeInstruction
 {
 	if([self.memory peekInstructionAtProgramCounter] == 0x0)
@@ -65,8 +80,9 @@
 
 	ushort rawInstruction = (ushort) [self.memory readInstructionAtProgramCounter];
 	CPUInstruction *instruction = [self.instructionBuilder buildFromMachineCode:rawInstruction usingCpuState:self];
+	BOOL skipped = self.ignoreNextInstruction;
 
-	if(!self.ignoreNextInstruction)
+	if(!skipped)
 	{
 		[instruction execute];
 	}
@@ -85,6 +101,11 @@
 		programCounterChanged = NO;
 	}
 
+	if(self.profiler != nil)
+	{
+		[self.profiler recordInstruction:rawInstruction skipped:skipped nextProgramCounter:(uint16_t) [self programCounter]];
+	}
+
 	return YES;
 }
 
@@ -25,6 +25,16 @@
 #define NUM_ITERALS     32
 #define NUM_REGISTERS   8
 
+// Memory writes are tracked per page so viewers only copy what changed.
+#define MEMORY_PAGE_WORDS   256
+#define MEMORY_PAGE_COUNT   (MEMORY_SIZE / MEMORY_PAGE_WORDS)
+#define MEMORY_PAGE_MASKS   (MEMORY_PAGE_COUNT / 32)
+
+#import "MemoryAccessCounters.h"
+
+// Instructions fetched per working set window unless told otherwise.
+#define MEMORY_WORKING_SET_WINDOW 1024
+
 // Indices for the RAM
 #define PC              @"PC" // program counter
 #define SP              @"SP" // stack pointer
@@ -41,6 +51,21 @@ typedef void(^generalRegisterOperationNotification)(int, int);
 
 typedef void(^memoryOperationNotification)(NSString *, int, int);
 
+struct memory_locality_stats
+{
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t fetches;
+	uint32_t wordsTouched;
+	uint32_t pagesTouched;
+	uint32_t stackDepthHighWater;
+
+	// Distinct pages per finished window of workingSetWindow fetched instructions.
+	uint32_t windows;
+	uint32_t peakWorkingSet;
+	double meanWorkingSet;
+};
+
 @interface Memory : NSObject
 
 @property(nonatomic, copy) memoryOperationNotification memoryWillChange;
@@ -51,10 +76,42 @@ typedef void(^memoryOperationNotification)(NSString *, int, int);
 @property(nonatomic, copy) generalRegisterOperationNotification generalRegisterWillChange;
 @property(nonatomic, copy) generalRegisterOperationNotification generalRegisterDidChange;
 
+// Counts reads, writes and instruction fetches per word and page while set. Turning it
+// on starts from zero counters, turning it off frees them.
+@property(nonatomic, assign) BOOL tracksAccesses;
+@property(nonatomic, assign) NSUInteger workingSetWindow;
+
 - (id)init;
 
 - (void)load:(NSArray *)values;
 
+// Throws if count is larger than MEMORY_SIZE.
+- (void)loadWords:(const uint16_t *)words count:(NSUInteger)count;
+
+// Copies words in at address without moving the start of data, e.g. to map a linked library.
+// Throws if address is outside memory or count is larger than MEMORY_SIZE.
+- (void)loadWords:(const uint16_t *)words count:(NSUInteger)count atAddress:(int)address;
+
+// Copies the bitmap of pages written since the last call into pages, which holds
+// MEMORY_PAGE_MASKS words, clears it and returns the number of dirty pages.
+- (NSUInteger)takeDirtyPages:(uint32_t *)pages;
+
+// Copies words out without counting them as guest reads.
+- (void)copyWordsInRange:(NSRange)range into:(uint16_t *)words;
+
+- (void)resetAccessCounts;
+
+- (void)readLocalityStats:(struct memory_locality_stats *)stats;
+
+// One uint32_t count per word of memory.
+- (NSData *)wordHeatmapOfKind:(enum memory_access_kind)kind;
+
+// One "page,reads,writes,fetches" line per page that was accessed, after a header line.
+- (NSString *)pageHeatmapCSV;
+
+// One uint16_t page count per finished window.
+- (NSData *)workingSets;
+
 - (void)setOverflowRegisterToValue:(int)value;
 
 - (int)getMemoryValueAtIndex:(int)index;
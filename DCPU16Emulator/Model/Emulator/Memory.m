@@ -25,6 +25,8 @@
 @interface Memory ()
 {
 	dispatch_queue_t q_default;
+	uint32_t dirtyPages[MEMORY_PAGE_MASKS];
+	struct memory_access_counters *accessCounters;
 }
 
 @property(nonatomic, strong) NSMutableDictionary *ram;
@@ -42,6 +44,7 @@
 @synthesize registerWillChange;
 @synthesize generalRegisterWillChange;
 @synthesize generalRegisterDidChange;
+@synthesize workingSetWindow;
 
 - (id)init
 {
@@ -82,9 +85,173 @@
 
 	q_default = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 
+	memset(dirtyPages, 0xFF, sizeof(dirtyPages));
+
+	workingSetWindow = MEMORY_WORKING_SET_WINDOW;
+
 	return self;
 }
 
+- (void)dealloc
+{
+	[self setTracksAccesses:NO];
+}
+
+- (BOOL)tracksAccesses
+{
+	return accessCounters != NULL;
+}
+
+- (void)setTracksAccesses:(BOOL)tracksAccesses
+{
+	if(tracksAccesses && accessCounters == NULL)
+	{
+		accessCounters = calloc(1, sizeof(struct memory_access_counters));
+		accessCounters->windowLength = (uint32_t) workingSetWindow;
+	}
+	else if(!tracksAccesses && accessCounters != NULL)
+	{
+		free(accessCounters->workingSets);
+		free(accessCounters);
+		accessCounters = NULL;
+	}
+}
+
+- (void)setWorkingSetWindow:(NSUInteger)window
+{
+	workingSetWindow = window;
+
+	if(accessCounters != NULL)
+	{
+		accessCounters->windowLength = (uint32_t) window;
+	}
+}
+
+- (void)resetAccessCounts
+{
+	if(accessCounters != NULL)
+	{
+		[self setTracksAccesses:NO];
+		[self setTracksAccesses:YES];
+	}
+}
+
+- (void)readLocalityStats:(struct memory_locality_stats *)stats
+{
+	memset(stats, 0, sizeof(*stats));
+
+	if(accessCounters == NULL)
+	{
+		return;
+	}
+
+	stats->reads = accessCounters->totals[MEMORY_ACCESS_READ];
+	stats->writes = accessCounters->totals[MEMORY_ACCESS_WRITE];
+	stats->fetches = accessCounters->totals[MEMORY_ACCESS_FETCH];
+	stats->stackDepthHighWater = accessCounters->stackDepthHighWater;
+
+	for(NSUInteger word = 0; word < MEMORY_SIZE; word++)
+	{
+		if(accessCounters->words[MEMORY_ACCESS_READ][word] != 0
+				|| accessCounters->words[MEMORY_ACCESS_WRITE][word] != 0
+				|| accessCounters->words[MEMORY_ACCESS_FETCH][word] != 0)
+		{
+			stats->wordsTouched++;
+		}
+	}
+
+	for(NSUInteger page = 0; page < MEMORY_PAGE_COUNT; page++)
+	{
+		if(accessCounters->pages[MEMORY_ACCESS_READ][page] != 0
+				|| accessCounters->pages[MEMORY_ACCESS_WRITE][page] != 0
+				|| accessCounters->pages[MEMORY_ACCESS_FETCH][page] != 0)
+		{
+			stats->pagesTouched++;
+		}
+	}
+
+	uint64_t sum = 0;
+
+	for(uint32_t i = 0; i < accessCounters->workingSetCount; i++)
+	{
+		uint32_t pages = accessCounters->workingSets[i];
+
+		sum += pages;
+		stats->peakWorkingSet = MAX(stats->peakWorkingSet, pages);
+	}
+
+	stats->windows = accessCounters->workingSetCount;
+	stats->meanWorkingSet = stats->windows == 0 ? 0 : (double) sum / stats->windows;
+}
+
+- (NSData *)wordHeatmapOfKind:(enum memory_access_kind)kind
+{
+	if(accessCounters == NULL)
+	{
+		return [NSData data];
+	}
+
+	return [NSData dataWithBytes:accessCounters->words[kind] length:sizeof(accessCounters->words[kind])];
+}
+
+- (NSString *)pageHeatmapCSV
+{
+	NSMutableString *csv = [NSMutableString stringWithString:@"page,reads,writes,fetches\n"];
+
+	if(accessCounters == NULL)
+	{
+		return csv;
+	}
+
+	for(NSUInteger page = 0; page < MEMORY_PAGE_COUNT; page++)
+	{
+		uint32_t reads = accessCounters->pages[MEMORY_ACCESS_READ][page];
+		uint32_t writes = accessCounters->pages[MEMORY_ACCESS_WRITE][page];
+		uint32_t fetches = accessCounters->pages[MEMORY_ACCESS_FETCH][page];
+
+		if(reads != 0 || writes != 0 || fetches != 0)
+		{
+			[csv appendFormat:@"%u,%u,%u,%u\n", (unsigned) page, reads, writes, fetches];
+		}
+	}
+
+	return csv;
+}
+
+- (NSData *)workingSets
+{
+	if(accessCounters == NULL)
+	{
+		return [NSData data];
+	}
+
+	return [NSData dataWithBytes:accessCounters->workingSets length:accessCounters->workingSetCount * sizeof(uint16_t)];
+}
+
+- (void)copyWordsInRange:(NSRange)range into:(uint16_t *)words
+{
+	NSMutableArray *memory = [ram objectForKey:MEM];
+
+	for(NSUInteger i = 0; i < range.length; i++)
+	{
+		words[i] = (uint16_t) [[memory objectAtIndex:range.location + i] intValue];
+	}
+}
+
+- (NSUInteger)takeDirtyPages:(uint32_t *)pages
+{
+	NSUInteger count = 0;
+
+	for(NSUInteger i = 0; i < MEMORY_PAGE_MASKS; i++)
+	{
+		pages[i] = dirtyPages[i];
+		count += (NSUInteger) __builtin_popcount(dirtyPages[i]);
+		dirtyPages[i] = 0;
+	}
+
+	return count;
+}
+
 - (void)load:(NSArray *)values
 {
 	int programSize = [values count];
@@ -97,6 +264,34 @@
 	startAddressOfData = programSize + 1;
 }
 
+- (void)loadWords:(const uint16_t *)words count:(NSUInteger)count
+{
+	if(count > MEMORY_SIZE)
+	{
+		@throw [NSString stringWithFormat:@"Image of %u words does not fit in memory", (unsigned) count];
+	}
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		[self setMemoryValue:words[i] atIndex:(int) i];
+	}
+
+	startAddressOfData = (int) count + 1;
+}
+
+- (void)loadWords:(const uint16_t *)words count:(NSUInteger)count atAddress:(int)address
+{
+	if(address < 0 || address >= MEMORY_SIZE || count > MEMORY_SIZE)
+	{
+		@throw [NSString stringWithFormat:@"Cannot load %u words at address %d", (unsigned) count, address];
+	}
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		[self setMemoryValue:words[i] atIndex:(address + (int) i) % MEMORY_SIZE];
+	}
+}
+
 - (void)setMemoryValue:(int)value atIndex:(int)index inMemoryArea:(NSString *)area
 {
 	NSMutableArray *memoryArea = [ram objectForKey:area];
@@ -144,6 +339,11 @@
 
 	[ram setValue:[NSNumber numberWithInt:newValue] forKey:registerKey];
 
+	if(accessCounters != NULL && [registerKey isEqualToString:SP])
+	{
+		memoryAccessCountersNoteStackPointer(accessCounters, newValue);
+	}
+
 	if(self.registerDidChange != nil)
 	{
 		self.registerDidChange(registerKey, newValue);
@@ -153,6 +353,17 @@
 
 - (void)setMemoryValue:(int)value atIndex:(int)index
 {
+	// Addresses wrap like the 16 bit address bus, and keep the dirty bitmap in bounds.
+	index &= MEMORY_SIZE - 1;
+
+	int page = index / MEMORY_PAGE_WORDS;
+	dirtyPages[page / 32] |= 1u << (page % 32);
+
+	if(accessCounters != NULL)
+	{
+		memoryAccessCountersRecord(accessCounters, MEMORY_ACCESS_WRITE, index);
+	}
+
 	[self setMemoryValue:value atIndex:index inMemoryArea:MEM];
 }
 
@@ -191,6 +402,12 @@
 - (int)readInstructionAtProgramCounter
 {
 	int value = [self peekInstructionAtProgramCounter];
+
+	if(accessCounters != NULL)
+	{
+		memoryAccessCountersRecord(accessCounters, MEMORY_ACCESS_FETCH, [self getProgramCounter]);
+	}
+
 	return value;
 }
 
@@ -224,6 +441,11 @@
 {
 	NSMutableArray *memory = [ram objectForKey:MEM];
 
+	if(accessCounters != NULL)
+	{
+		memoryAccessCountersRecord(accessCounters, MEMORY_ACCESS_READ, index);
+	}
+
 	return [[memory objectAtIndex:(NSUInteger) index] intValue];
 }
 
@@ -267,8 +489,14 @@
 - (int)peek
 {
 	NSMutableArray *memory = [ram objectForKey:MEM];
+	int stackPointer = [[ram objectForKey:SP] intValue];
+
+	if(accessCounters != NULL)
+	{
+		memoryAccessCountersRecord(accessCounters, MEMORY_ACCESS_READ, stackPointer);
+	}
 
-	return [[memory objectAtIndex:(NSUInteger) [[ram objectForKey:SP] intValue]] intValue];
+	return [[memory objectAtIndex:(NSUInteger) stackPointer] intValue];
 }
 
 - (int)getProgramCounter
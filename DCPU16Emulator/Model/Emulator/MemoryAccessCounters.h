@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Per word and per page access counters kept by Memory while access tracking is on.
+// Memory holds a NULL pointer when tracking is off so every access pays one branch.
+enum memory_access_kind
+{
+	MEMORY_ACCESS_READ = 0,
+	MEMORY_ACCESS_WRITE,
+	MEMORY_ACCESS_FETCH,
+	MEMORY_ACCESS_KINDS
+};
+
+struct memory_access_counters
+{
+	uint32_t words[MEMORY_ACCESS_KINDS][MEMORY_SIZE];
+	uint32_t pages[MEMORY_ACCESS_KINDS][MEMORY_PAGE_COUNT];
+	uint64_t totals[MEMORY_ACCESS_KINDS];
+
+	// Lowest stack pointer seen; the stack grows down from the top of memory.
+	uint32_t stackDepthHighWater;
+
+	// Pages touched in the current window of fetched instructions.
+	uint32_t windowPages[MEMORY_PAGE_MASKS];
+	uint32_t windowLength;
+	uint32_t windowFetches;
+
+	// Distinct pages touched by each finished window.
+	uint16_t *workingSets;
+	uint32_t workingSetCount;
+	uint32_t workingSetCapacity;
+};
+
+static inline void memoryAccessCountersCloseWindow(struct memory_access_counters *counters)
+{
+	if(counters->workingSetCount == counters->workingSetCapacity)
+	{
+		counters->workingSetCapacity = counters->workingSetCapacity == 0 ? 64 : counters->workingSetCapacity * 2;
+		counters->workingSets = realloc(counters->workingSets, counters->workingSetCapacity * sizeof(uint16_t));
+	}
+
+	uint32_t pages = 0;
+
+	for(int i = 0; i < MEMORY_PAGE_MASKS; i++)
+	{
+		pages += (uint32_t) __builtin_popcount(counters->windowPages[i]);
+	}
+
+	counters->workingSets[counters->workingSetCount++] = (uint16_t) pages;
+	counters->windowFetches = 0;
+	memset(counters->windowPages, 0, sizeof(counters->windowPages));
+}
+
+static inline void memoryAccessCountersRecord(struct memory_access_counters *counters, enum memory_access_kind kind, int index)
+{
+	int word = index & (MEMORY_SIZE - 1);
+	int page = word / MEMORY_PAGE_WORDS;
+
+	counters->words[kind][word]++;
+	counters->pages[kind][page]++;
+	counters->totals[kind]++;
+	counters->windowPages[page / 32] |= 1u << (page % 32);
+
+	if(kind == MEMORY_ACCESS_FETCH && ++counters->windowFetches == counters->windowLength)
+	{
+		memoryAccessCountersCloseWindow(counters);
+	}
+}
+
+static inline void memoryAccessCountersNoteStackPointer(struct memory_access_counters *counters, int stackPointer)
+{
+	uint32_t depth = (uint32_t) (MEMORY_SIZE - (stackPointer & (MEMORY_SIZE - 1))) & (MEMORY_SIZE - 1);
+
+	if(depth > counters->stackDepthHighWater)
+	{
+		counters->stackDepthHighWater = depth;
+	}
+}
@@ -80,56 +80,27 @@
 	self.label = @"";
 }
 
+// Shared choice lists, one per input state, built once instead of on every keystroke.
 - (NSArray *)possibleNextInput
 {
-	NSMutableArray *possibleInputList = [[NSMutableArray alloc] init];
+	static NSArray *choicesForState[Complete + 1];
+	static dispatch_once_t once;
 
-	if(instructionState == WaitForOpcodeOrLabel)
+	dispatch_once(&once, ^
 	{
-		[possibleInputList addObject:@"Label"];
-	}
+		NSArray *opcodes = @[@"JSR", @"SET", @"SHL", @"MOD", @"AND", @"BOR", @"XOR", @"SHR",
+				@"SHL", @"ADD", @"SUB", @"MUL", @"DIV", @"IFE", @"IFN", @"IFG", @"IFB"];
+		NSArray *operands = @[@"PC", @"SP", @"O", @"A", @"B", @"C", @"X", @"Y", @"Z", @"I", @"J",
+				@"Lit", @"Ref", @"PUSH", @"POP", @"PEEK"];
 
-	if(instructionState == WaitForOpcodeOrLabel || instructionState == WaitForOpcode)
-	{
-		[possibleInputList addObject:@"JSR"];
-		[possibleInputList addObject:@"SET"];
-		[possibleInputList addObject:@"SHL"];
-		[possibleInputList addObject:@"MOD"];
-		[possibleInputList addObject:@"AND"];
-		[possibleInputList addObject:@"BOR"];
-		[possibleInputList addObject:@"XOR"];
-		[possibleInputList addObject:@"SHR"];
-		[possibleInputList addObject:@"SHL"];
-		[possibleInputList addObject:@"ADD"];
-		[possibleInputList addObject:@"SUB"];
-		[possibleInputList addObject:@"MUL"];
-		[possibleInputList addObject:@"DIV"];
-		[possibleInputList addObject:@"IFE"];
-		[possibleInputList addObject:@"IFN"];
-		[possibleInputList addObject:@"IFG"];
-		[possibleInputList addObject:@"IFB"];
-	}
-	else if(instructionState == WaitForOperand1 || instructionState == WaitForOperand2)
-	{
-		[possibleInputList addObject:@"PC"];
-		[possibleInputList addObject:@"SP"];
-		[possibleInputList addObject:@"O"];
-		[possibleInputList addObject:@"A"];
-		[possibleInputList addObject:@"B"];
-		[possibleInputList addObject:@"C"];
-		[possibleInputList addObject:@"X"];
-		[possibleInputList addObject:@"Y"];
-		[possibleInputList addObject:@"Z"];
-		[possibleInputList addObject:@"I"];
-		[possibleInputList addObject:@"J"];
-		[possibleInputList addObject:@"Lit"];
-		[possibleInputList addObject:@"Ref"];
-		[possibleInputList addObject:@"PUSH"];
-		[possibleInputList addObject:@"POP"];
-		[possibleInputList addObject:@"PEEK"];
-	}
+		choicesForState[WaitForOpcodeOrLabel] = [@[@"Label"] arrayByAddingObjectsFromArray:opcodes];
+		choicesForState[WaitForOpcode] = opcodes;
+		choicesForState[WaitForOperand1] = operands;
+		choicesForState[WaitForOperand2] = operands;
+		choicesForState[Complete] = @[];
+	});
 
-	return possibleInputList;
+	return choicesForState[instructionState];
 }
 
 @end
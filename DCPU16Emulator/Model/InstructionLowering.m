@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "InstructionLowering.h"
+#import "OperandFactory.h"
+#import "Match.h"
+#import "NSString+ParseHex_ParseInt.h"
+
+static NSString *const registerNames[] = {
+	@"A", @"B", @"C", @"X", @"Y", @"Z", @"I", @"J", @"POP", @"PUSH", @"PEEK", @"PC", @"SP", @"O"
+};
+
+static BOOL isRegisterName(NSString *text)
+{
+	for(NSUInteger i = 0; i < sizeof(registerNames) / sizeof(registerNames[0]); i++)
+	{
+		if([text caseInsensitiveCompare:registerNames[i]] == NSOrderedSame)
+		{
+			return YES;
+		}
+	}
+
+	return NO;
+}
+
+static BOOL hasOnlyCharacters(NSString *text, NSUInteger from, NSCharacterSet *characters)
+{
+	NSUInteger length = [text length];
+
+	if(length <= from)
+	{
+		return NO;
+	}
+
+	for(NSUInteger i = from; i < length; i++)
+	{
+		if(![characters characterIsMember:[text characterAtIndex:i]])
+		{
+			return NO;
+		}
+	}
+
+	return YES;
+}
+
+// A whole "..." or @"..." literal, with embedded quotes doubled as the lexer expects.
+static BOOL isStringLiteral(NSString *text)
+{
+	NSUInteger start = [text hasPrefix:@"@"] ? 1 : 0;
+	NSUInteger length = [text length];
+
+	if(length < start + 2 || [text characterAtIndex:start] != '"' || [text characterAtIndex:length - 1] != '"')
+	{
+		return NO;
+	}
+
+	NSString *body = [text substringWithRange:NSMakeRange(start + 1, length - start - 2)];
+
+	return [[body stringByReplacingOccurrencesOfString:@"\"\"" withString:@""] rangeOfString:@"\""].location == NSNotFound;
+}
+
+@interface InstructionLowering ()
+
+@property(nonatomic, strong) OperandFactory *operandFactory;
+@property(nonatomic, strong) NSCharacterSet *decimalDigits;
+@property(nonatomic, strong) NSCharacterSet *hexDigits;
+@property(nonatomic, strong) NSCharacterSet *labelCharacters;
+
+@end
+
+@implementation InstructionLowering
+
+@synthesize operandFactory;
+@synthesize decimalDigits;
+@synthesize hexDigits;
+@synthesize labelCharacters;
+
+- (id)init
+{
+	self = [super init];
+
+	self.operandFactory = [[OperandFactory alloc] init];
+	self.decimalDigits = [NSCharacterSet characterSetWithCharactersInString:@"0123456789"];
+	self.hexDigits = [NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdefABCDEF"];
+	self.labelCharacters = [NSCharacterSet characterSetWithCharactersInString:
+			@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_"];
+
+	return self;
+}
+
+- (Statment *)statmentForInstruction:(Instruction *)instruction
+{
+	Statment *statment = [[Statment alloc] init];
+
+	if([instruction.label length] > 0)
+	{
+		statment.label = instruction.label;
+	}
+
+	statment.menemonic = instruction.opcode != nil ? [instruction.opcode uppercaseString] : @"";
+
+	if(statment.isData)
+	{
+		[self addDataText:instruction.operand1 toStatment:statment];
+		[self addDataText:instruction.operand2 toStatment:statment];
+		return statment;
+	}
+
+	statment.firstOperand = [self operandForText:instruction.operand1];
+
+	if([instruction.operand2 length] > 0)
+	{
+		statment.secondOperand = [self operandForText:instruction.operand2];
+	}
+	else
+	{
+		statment.secondOperand = [Operand newOperand:O_NULL];
+	}
+
+	return statment;
+}
+
+- (void)addDataText:(NSString *)text toStatment:(Statment *)statment
+{
+	if([text length] == 0)
+	{
+		return;
+	}
+
+	Match *match = [self matchForText:text];
+
+	if(match.token == HEX)
+	{
+		[statment addDat:[match.content parseHexLiteral]];
+	}
+	else if(match.token == INT)
+	{
+		[statment addDat:[match.content parseDecimalLiteral]];
+	}
+	else if(match.token == STRING)
+	{
+		[statment addDatCharacters:match.content];
+	}
+	else
+	{
+		@throw [NSString stringWithFormat:@"Expected operand found '%@'", text];
+	}
+}
+
+- (Operand *)operandForText:(NSString *)text
+{
+	NSString *trimmed = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+	Operand *operand = nil;
+
+	if([trimmed hasPrefix:@"["] && [trimmed hasSuffix:@"]"] && [trimmed length] > 2)
+	{
+		operand = [self indirectOperandForText:[trimmed substringWithRange:NSMakeRange(1, [trimmed length] - 2)]];
+	}
+	else
+	{
+		operand = [self.operandFactory createDirectOperandForMatch:[self matchForText:trimmed]];
+	}
+
+	if(operand == nil)
+	{
+		@throw [NSString stringWithFormat:@"Expected operand found '%@'", text];
+	}
+
+	return operand;
+}
+
+- (Operand *)indirectOperandForText:(NSString *)text
+{
+	NSRange plus = [text rangeOfString:@"+"];
+
+	if(plus.location == NSNotFound)
+	{
+		return [self.operandFactory createIndirectOperandForMatch:[self matchForText:text]];
+	}
+
+	Match *left = [self matchForText:[text substringToIndex:plus.location]];
+	Match *right = [self matchForText:[text substringFromIndex:NSMaxRange(plus)]];
+
+	if(right.token != REGISTER)
+	{
+		return nil;
+	}
+
+	return [self.operandFactory createIndirectOffsetOperandForMatch:right leftToken:left inArena:nil];
+}
+
+// Same precedence as the lexer: registers, then hex and decimal literals, then strings and label references.
+- (Match *)matchForText:(NSString *)text
+{
+	NSString *trimmed = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+	enum LexerTokenType token = ENDOFFILE;
+
+	if(isRegisterName(trimmed))
+	{
+		token = REGISTER;
+	}
+	else if(([trimmed hasPrefix:@"0x"] || [trimmed hasPrefix:@"0X"]) && hasOnlyCharacters(trimmed, 2, self.hexDigits))
+	{
+		token = HEX;
+	}
+	else if(hasOnlyCharacters(trimmed, 0, self.decimalDigits))
+	{
+		token = INT;
+	}
+	else if(isStringLiteral(trimmed))
+	{
+		token = STRING;
+	}
+	else if(hasOnlyCharacters(trimmed, 0, self.labelCharacters))
+	{
+		token = LABELREF;
+	}
+
+	return [[Match alloc] initWithToken:token content:trimmed];
+}
+
+@end
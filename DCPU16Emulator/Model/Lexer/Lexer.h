@@ -25,10 +25,15 @@
 #import "IgnoreTokenStrategy.h"
 #import "ConsumeTokenStrategy.h"
 #import "LexerProtocol.h"
+#import "PipelineStats.h"
 
 @interface Lexer : NSObject <LexerProtocol>
 
 - (id)initWithIgnoreTokenStrategy:(id<IgnoreTokenStrategy>)ignoreStrategy
 			 consumeTokenStrategy:(id<ConsumeTokenStrategy>)consumeStrategy;
 
+@property(nonatomic, readonly) struct pipeline_stats stats;
+
+- (void)resetStats;
+
 @end
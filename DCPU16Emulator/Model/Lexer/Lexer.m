@@ -45,17 +45,25 @@
 {
 	int lineNumber;
 	int columnNumber;
+	int tokenLineNumber;
+	int tokenColumnNumber;
+	int tokenLength;
+	struct pipeline_stats stats;
 }
 
 @synthesize scanner;
 @synthesize token;
 @synthesize lineNumber;
 @synthesize columnNumber;
+@synthesize tokenLineNumber;
+@synthesize tokenColumnNumber;
+@synthesize tokenLength;
 @synthesize match;
 @synthesize ignoreTokenStrategy;
 @synthesize consumeTokenStrategy;
 
 @synthesize lineRemaining;
+@synthesize stats;
 
 - (id)init
 {
@@ -65,6 +73,7 @@
                          [[RegexTokenMatcher alloc] initWithToken:WHITESPACE pattern:@"(\\r\\n|\\s+)"],
                          [[RegexTokenMatcher alloc] initWithToken:COMMENT pattern:@";.*$"],
                          [[RegexTokenMatcher alloc] initWithToken:LABEL pattern:@":\\w+"],
+                         [[RegexTokenMatcher alloc] initWithToken:DIRECTIVE pattern:@"\\.((?i)incbin)\\b"],
                          [[RegexTokenMatcher alloc] initWithToken:HEX pattern:@"(0x[0-9a-fA-F]+)"],
                          [[RegexTokenMatcher alloc] initWithToken:INT pattern:@"[0-9]+"],
                          [[RegexTokenMatcher alloc] initWithToken:PLUS pattern:@"\\+"],
@@ -100,6 +109,11 @@
 	return self;
 }
 
+- (void)resetStats
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
 - (enum LexerTokenType)token
 {
 	return self.match.token;
@@ -111,8 +125,15 @@
 }
 
 - (void)lexSource:(NSString*)source
+{
+	[self lexSource:source startingAtLine:0];
+}
+
+- (void)lexSource:(NSString *)source startingAtLine:(int)line
 {
 	self.scanner = [NSScanner scannerWithString:source];
+	lineNumber = line + 1;
+	columnNumber = 0;
 	[self readNextLine];
 }
 
@@ -122,22 +143,37 @@
 
 		do
 		{
+			NSUInteger scanStart = [self.scanner scanLocation];
+
 			[self.scanner
 					scanUpToCharactersFromSet:[NSCharacterSet newlineCharacterSet]
 					intoString:&readLine];
 
-			[self setLineAndColumnNumberForNewLine:readLine];
+			[self setLineAndColumnNumberForNewLine:readLine skippedFrom:scanStart];
+			PIPELINE_STATS_ADD(stats, allocations, readLine != nil ? 1 : 0);
 
 			self.lineRemaining = readLine;
 
 		} while(self.lineRemaining != nil && [self.lineRemaining length] == 0);
 }
 
-- (void)setLineAndColumnNumberForNewLine:(NSString *)newLine
+// The scanner silently skips blank lines, so count the line feeds it jumped over
+// to keep lineNumber pointing at the physical source line.
+- (void)setLineAndColumnNumberForNewLine:(NSString *)newLine skippedFrom:(NSUInteger)scanStart
 {
 	if(newLine != nil)
 	{
-		lineNumber++;
+		NSString *source = [self.scanner string];
+		NSUInteger lineStart = [self.scanner scanLocation] - [newLine length];
+
+		for(NSUInteger i = scanStart; i < lineStart; i++)
+		{
+			if([source characterAtIndex:i] == '\n')
+			{
+				lineNumber++;
+			}
+		}
+
 		columnNumber = 0;
 	}
 }
@@ -155,6 +191,14 @@
 	return result;
 }
 
+- (void)skipLine
+{
+	if(lineRemaining != nil)
+	{
+		[self readNextLine];
+	}
+}
+
 - (BOOL)nextToken
 {
 	if(lineRemaining == nil)
@@ -174,6 +218,10 @@
 
 - (void)matchToken
 {
+	PIPELINE_STATS_START(start);
+	PIPELINE_STATS_ADD(stats, tokensLexed, 1);
+	PIPELINE_STATS_ADD(stats, regexEvaluations, [self.tokenMatchers count]);
+
 	NSArray *matchers = [self.tokenMatchers where:^(id obj)
 	{
 		id <TokenMatcher> matcher = (id <TokenMatcher>) obj;
@@ -183,16 +231,39 @@
 
 	id <TokenMatcher> tokenMatcher = [matchers firstObject];
 
+	tokenLineNumber = lineNumber;
+	tokenColumnNumber = columnNumber;
+
 	if(tokenMatcher == nil)
 	{
+		tokenLength = [self lengthOfUnmatchedText];
+
 		@throw [NSString stringWithFormat:@"Unable to match against any tokens at line %d position %d \"%@\"",
 										  lineNumber,
 										  columnNumber,
 										  lineRemaining];
 	}
 
+	tokenLength = (int) [tokenMatcher.content length];
 	self.match = tokenMatcher;
 	[self consumeToken:tokenMatcher.token characters:tokenMatcher.content];
+
+	PIPELINE_STATS_STOP(stats, lexTime, start);
+}
+
+- (int)lengthOfUnmatchedText
+{
+	NSMutableCharacterSet *separators = [NSMutableCharacterSet whitespaceCharacterSet];
+	[separators addCharactersInString:@",+[]();"];
+
+	NSRange separator = [self.lineRemaining rangeOfCharacterFromSet:separators];
+
+	if(separator.location == NSNotFound)
+	{
+		return (int) [self.lineRemaining length];
+	}
+
+	return (int) MAX(separator.location, (NSUInteger) 1);
 }
 
 - (void)consumeToken:(enum LexerTokenType)tkn characters:(NSString *)matched
@@ -201,12 +272,17 @@
 	{
 		columnNumber += [matched length];
 		self.lineRemaining = [self.lineRemaining substringFromIndex:[matched length]];
+		PIPELINE_STATS_ADD(stats, allocations, 1);
 
 		if([self.lineRemaining length] == 0)
 		{
 			[self readNextLine];
 		}
 	}
+	else
+	{
+		PIPELINE_STATS_ADD(stats, tokensRelexed, 1);
+	}
 }
 
 @end
@@ -35,12 +35,23 @@
 
 @property(nonatomic, readonly) int columnNumber;
 
+// Where the current token, or the text the lexer failed to match, starts and how long it is.
+@property(nonatomic, readonly) int tokenLineNumber;
+
+@property(nonatomic, readonly) int tokenColumnNumber;
+
+@property(nonatomic, readonly) int tokenLength;
+
 @property(nonatomic, strong) Match *match;
 
 - (void)lexSource:(NSString*)source;
 
+- (void)lexSource:(NSString *)source startingAtLine:(int)line;
+
 - (BOOL)nextToken;
 
 - (BOOL)nextTokenUsingStrategy:(id <ConsumeTokenStrategy>)strategy;
 
+- (void)skipLine;
+
 @end
\ No newline at end of file
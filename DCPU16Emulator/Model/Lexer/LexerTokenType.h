@@ -35,5 +35,6 @@ enum LexerTokenType
 	PLUS = 10,
 	WHITESPACE = 11,
 	COMMENT = 12,
-	ENDOFFILE = 13
+	ENDOFFILE = 13,
+	DIRECTIVE = 14
 };
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#include <mach/mach_time.h>
+
+// Counters and wall times for the assembly pipeline. Lexer, Parser, Assembler,
+// IncrementalAssembler and Program each keep one; the counting code is only compiled
+// into DEBUG builds, release builds keep the struct but always report zeros.
+#if DEBUG
+#define PIPELINE_STATS_ENABLED 1
+#else
+#define PIPELINE_STATS_ENABLED 0
+#endif
+
+struct pipeline_stats
+{
+	// Nanoseconds; parse time includes the lexing the parser drives.
+	uint64_t lexTime;
+	uint64_t parseTime;
+	uint64_t assembleTime;
+	uint64_t programAssembleTime;
+
+	uint64_t runs;
+	uint64_t tokensLexed;
+	uint64_t regexEvaluations;
+
+	// Tokens matched by a peek and therefore matched again by the next call.
+	uint64_t tokensRelexed;
+
+	// Rows and label fixups encoded by the assembler.
+	uint64_t statments;
+	uint64_t fixups;
+
+	// Objects and buffers created by the pipeline's own code: lexer line and token
+	// strings, statments, and assembler columns and buffer growth.
+	uint64_t allocations;
+};
+
+#if PIPELINE_STATS_ENABLED
+#define PIPELINE_STATS_ADD(stats, field, amount) ((stats).field += (amount))
+#define PIPELINE_STATS_START(start) uint64_t start = pipelineStatsNow()
+#define PIPELINE_STATS_STOP(stats, field, start) ((stats).field += pipelineStatsNow() - (start))
+#else
+#define PIPELINE_STATS_ADD(stats, field, amount) ((void) 0)
+#define PIPELINE_STATS_START(start) ((void) 0)
+#define PIPELINE_STATS_STOP(stats, field, start) ((void) 0)
+#endif
+
+static inline uint64_t pipelineStatsNow(void)
+{
+	static mach_timebase_info_data_t timebase;
+
+	if(timebase.denom == 0)
+	{
+		mach_timebase_info(&timebase);
+	}
+
+	return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+static inline void pipelineStatsAdd(struct pipeline_stats *total, const struct pipeline_stats *run)
+{
+	total->lexTime += run->lexTime;
+	total->parseTime += run->parseTime;
+	total->assembleTime += run->assembleTime;
+	total->programAssembleTime += run->programAssembleTime;
+	total->runs += run->runs;
+	total->tokensLexed += run->tokensLexed;
+	total->regexEvaluations += run->regexEvaluations;
+	total->tokensRelexed += run->tokensRelexed;
+	total->statments += run->statments;
+	total->fixups += run->fixups;
+	total->allocations += run->allocations;
+}
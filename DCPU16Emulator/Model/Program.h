@@ -21,13 +21,28 @@
  */
 
 #import "Instruction.h"
+#import "PipelineStats.h"
+#import "ProgramDelegate.h"
 
 @interface Program : NSObject
 
-@property(strong, nonatomic, readonly) NSMutableArray *assembledInstructionSet;
+@property(weak, nonatomic) id <ProgramDelegate> delegate;
+@property(strong, nonatomic, readonly) Instruction *currentInstruction;
+@property(strong, nonatomic, readonly) NSArray *instructionSet;
+
+@property(strong, nonatomic, readonly) NSData *assembledImage;
+
+// Counters and stage times of the last assemble call; zero outside DEBUG builds.
+@property(nonatomic, readonly) struct pipeline_stats lastAssembleStats;
+
+// Word ranges of assembledImage that differ from the previous assemble call.
+@property(strong, nonatomic, readonly) NSArray *changedAddressRanges;
 
 - (NSString *)assemble;
 
+// Delivers pending changes to the delegate now instead of on the next run loop turn.
+- (void)flushChanges;
+
 - (void)FinishedInstructionEdit;
 
 - (void)resetCurrentInstruction;
@@ -21,152 +21,147 @@
  */
 
 #import "Program.h"
-#import "Parser.h"
-#import "Assembler.h"
-#import "IgnoreWhiteSpaceTokenStrategy.h"
-#import "ConsumeToken.h"
-#import "Lexer.h"
+#import "IncrementalAssembler.h"
+#import "InstructionLowering.h"
 
 @interface Program ()
+{
+	enum program_change pendingChanges;
+}
 
-@property(strong, nonatomic) NSMutableArray *instructionSet;
-@property(strong, nonatomic) Instruction *currentInstruction;
-@property(strong, nonatomic, readwrite) NSMutableArray *assembledInstructionSet;
+@property(strong, nonatomic) NSMutableArray *instructions;
+@property(strong, nonatomic, readwrite) Instruction *currentInstruction;
+@property(strong, nonatomic, readwrite) NSData *assembledImage;
+@property(strong, nonatomic, readwrite) NSArray *changedAddressRanges;
+@property(strong, nonatomic) IncrementalAssembler *incrementalAssembler;
+@property(strong, nonatomic) InstructionLowering *lowering;
 
 @end
 
 @implementation Program
 
-@synthesize instructionSet;
+@synthesize delegate;
+@synthesize instructions;
 @synthesize currentInstruction;
-@synthesize assembledInstructionSet;
+@synthesize assembledImage;
+@synthesize changedAddressRanges;
+@synthesize incrementalAssembler;
+@synthesize lowering;
+@synthesize lastAssembleStats;
 
 - (id)init
 {
 	self = [super init];
 
 	self.currentInstruction = [[Instruction alloc] init];
-	self.instructionSet = [[NSMutableArray alloc] init];
+	self.instructions = [[NSMutableArray alloc] init];
+	self.incrementalAssembler = [[IncrementalAssembler alloc] init];
+	self.lowering = [[InstructionLowering alloc] init];
 
-	[self notifyEditStateChanged];
-	[self notifyInstructionChanged];
-	[self notifyInstructionSetChanged];
+	[self noteChanges:PROGRAM_EDIT_STATE_CHANGED | PROGRAM_INSTRUCTION_CHANGED | PROGRAM_INSTRUCTION_SET_CHANGED];
 
 	return self;
 }
 
-- (void)notifyEditStateChanged
+- (NSArray *)instructionSet
 {
-	NSArray *availableStates = [self.currentInstruction possibleNextInput];
-	[[NSNotificationCenter defaultCenter] postNotificationName:@"EditStateChanged" object:availableStates];
+	return self.instructions;
 }
 
-- (void)notifyInstructionChanged
+- (void)noteChanges:(enum program_change)changes
 {
-	// TODO Investigate this:
-	/*
- NSDictionary* instructionData = [NSDictionary dictionaryWithObjectsAndKeys:
-  self.currentInstruction.label != nil ? self.currentInstruction.label : @"", @"label",
- self.currentInstruction.opcode != nil ? self.currentInstruction.opcode : @"", @"opcode",
- self.currentInstruction.operand1 != nil ? self.currentInstruction.operand1 : @"", @"operand1",
- self.currentInstruction.operand2 != nil ? self.currentInstruction.operand2 : @"", @"operand2",
- [NSNumber numberWithInt:self.currentInstruction.state], @"state",nil];
-*/
-
-	NSDictionary *instructionData = [[NSMutableDictionary alloc] init];
-	[instructionData setValue:self.currentInstruction.label != nil ? self.currentInstruction.label : @"" forKey:@"label"];
-	[instructionData setValue:self.currentInstruction.opcode != nil ? self.currentInstruction.opcode : @"" forKey:@"opcode"];
-	[instructionData setValue:self.currentInstruction.operand1 != nil ? self.currentInstruction.operand1 : @"" forKey:@"operand1"];
-	[instructionData setValue:self.currentInstruction.operand2 != nil ? self.currentInstruction.operand2 : @"" forKey:@"operand2"];
-	[instructionData setValue:[NSNumber numberWithInt:self.currentInstruction.state] forKey:@"state"];
-
-	[[NSNotificationCenter defaultCenter] postNotificationName:@"InstructionChanged" object:instructionData];
+	if(pendingChanges == 0)
+	{
+		[self performSelector:@selector(flushChanges) withObject:nil afterDelay:0];
+	}
+
+	pendingChanges |= changes;
 }
 
-- (void)notifyInstructionSetChanged
+- (void)flushChanges
 {
-	NSArray *instructionSetData = self.instructionSet;
-	[[NSNotificationCenter defaultCenter] postNotificationName:@"InstructionSetChanged" object:instructionSetData];
+	enum program_change changes = pendingChanges;
+
+	if(changes == 0)
+	{
+		return;
+	}
+
+	pendingChanges = 0;
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(flushChanges) object:nil];
+
+	id <ProgramDelegate> programDelegate = self.delegate;
+
+	if((changes & PROGRAM_EDIT_STATE_CHANGED) && [programDelegate respondsToSelector:@selector(program:didChangePossibleNextInput:)])
+	{
+		[programDelegate program:self didChangePossibleNextInput:[self.currentInstruction possibleNextInput]];
+	}
+
+	if((changes & PROGRAM_INSTRUCTION_CHANGED) && [programDelegate respondsToSelector:@selector(program:didChangeCurrentInstruction:)])
+	{
+		[programDelegate program:self didChangeCurrentInstruction:self.currentInstruction];
+	}
+
+	if((changes & PROGRAM_INSTRUCTION_SET_CHANGED) && [programDelegate respondsToSelector:@selector(program:didChangeInstructionSet:)])
+	{
+		[programDelegate program:self didChangeInstructionSet:self.instructions];
+	}
 }
 
 - (void)assignLabelToCurrentInstruction:(NSString *)value
 {
 	[self.currentInstruction assignLabel:value];
-	[self notifyEditStateChanged];
-	[self notifyInstructionChanged];
+	[self noteChanges:PROGRAM_EDIT_STATE_CHANGED | PROGRAM_INSTRUCTION_CHANGED];
 }
 
 - (void)assignValueToCurrentInstruction:(NSString *)value
 {
 	[self.currentInstruction assignValue:value];
-	[self notifyEditStateChanged];
-	[self notifyInstructionChanged];
+	[self noteChanges:PROGRAM_EDIT_STATE_CHANGED | PROGRAM_INSTRUCTION_CHANGED];
 }
 
 - (void)resetCurrentInstruction
 {
 	[self.currentInstruction reset];
-	[self notifyEditStateChanged];
-	[self notifyInstructionChanged];
+	[self noteChanges:PROGRAM_EDIT_STATE_CHANGED | PROGRAM_INSTRUCTION_CHANGED];
 }
 
 - (void)FinishedInstructionEdit
 {
-	[self.instructionSet addObject:self.currentInstruction];
+	[self.instructions addObject:self.currentInstruction];
 
 	self.currentInstruction = nil;
 	self.currentInstruction = [[Instruction alloc] init];
 
-	[self notifyEditStateChanged];
-	[self notifyInstructionChanged];
-	[self notifyInstructionSetChanged];
+	[self noteChanges:PROGRAM_EDIT_STATE_CHANGED | PROGRAM_INSTRUCTION_CHANGED | PROGRAM_INSTRUCTION_SET_CHANGED];
 }
 
 - (NSString *)assemble
 {
-	NSMutableString *source;
-	source = [self generateSourceFromInstructions];
-
-	NSString *code = source;
-
-	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
-											 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+	PIPELINE_STATS_START(start);
+	InstructionLowering *instructionLowering = self.lowering;
 
-	Parser *p = [[Parser alloc] init];
-	[p parseSource:code withLexer:lexer];
+	[self.incrementalAssembler resetStats];
 
-	Assembler *assembler = [[Assembler alloc] init];
-	[assembler assembleStatments:p.statments];
+	// Finished instructions are never edited again, so the diff can compare them by identity.
+	self.changedAddressRanges = [self.incrementalAssembler assembleLines:[NSArray arrayWithArray:self.instructions]
+																lowering:^Statment *(id line)
+																{
+																	return [instructionLowering statmentForInstruction:line];
+																}];
+	self.assembledImage = [self.incrementalAssembler image];
 
-	int programInstructionSize = [assembler.program count];
+	lastAssembleStats = self.incrementalAssembler.stats;
+	PIPELINE_STATS_STOP(lastAssembleStats, programAssembleTime, start);
 
 	NSMutableString *assembledCode = [NSMutableString string];
-	[self.assembledInstructionSet removeAllObjects];
 
-	for(NSUInteger i = 0; i < programInstructionSize; i++)
+	for(NSUInteger i = 0; i < self.incrementalAssembler.wordCount; i++)
 	{
-		int assembledInstruction = [[assembler.program objectAtIndex:i] intValue];
-
-		[self.assembledInstructionSet addObject:[assembler.program objectAtIndex:i]];
-		[assembledCode appendString:[NSString stringWithFormat:@"0x%X ", assembledInstruction]];
+		[assembledCode appendFormat:@"0x%X ", self.incrementalAssembler.words[i]];
 	}
 
 	return assembledCode;
 }
 
-- (NSMutableString *)generateSourceFromInstructions
-{
-	NSMutableString *source = [NSMutableString string];
-
-	for(Instruction *instruction in self.instructionSet)
-	{
-		[source appendString:[NSString stringWithFormat:@"%@ %@ %@, %@\n",
-														instruction.label != nil ? instruction.label : @"",
-														instruction.opcode != nil ? instruction.opcode : @"",
-														instruction.operand1 != nil ? instruction.operand1 : @"",
-														instruction.operand2 != nil ? instruction.operand2 : @""]];
-	}
-	return source;
-}
-
 @end
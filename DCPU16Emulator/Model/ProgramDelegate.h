@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class Program;
+@class Instruction;
+
+enum program_change
+{
+	PROGRAM_EDIT_STATE_CHANGED = 1 << 0,
+	PROGRAM_INSTRUCTION_CHANGED = 1 << 1,
+	PROGRAM_INSTRUCTION_SET_CHANGED = 1 << 2,
+};
+
+// Program coalesces its edits and calls each method at most once per run loop turn,
+// with the latest state rather than one call per keystroke.
+@protocol ProgramDelegate <NSObject>
+
+@optional
+
+- (void)program:(Program *)program didChangePossibleNextInput:(NSArray *)possibleNextInput;
+
+- (void)program:(Program *)program didChangeCurrentInstruction:(Instruction *)instruction;
+
+- (void)program:(Program *)program didChangeInstructionSet:(NSArray *)instructionSet;
+
+@end
@@ -97,4 +97,6 @@ enum operand_special_register
 
 - (int)assembleOperandWithIndex:(int)index;
 
+- (enum operand_type)operandType;
+
 @end
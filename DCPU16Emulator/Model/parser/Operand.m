@@ -80,6 +80,11 @@
 	return [self assembleWithShift:shift];
 }
 
+- (enum operand_type)operandType
+{
+	return O_NULL;
+}
+
 + (enum operand_type)operandTypeForName:(NSString *)name
 {
 	if([name length] == 1 && (
@@ -140,7 +145,7 @@
 		case O_PC:
 			return [[ProgramCounterOperand alloc] init];
 		case O_O:
-			break;
+			return [[OverflowOperand alloc] init];
 		case O_INDIRECT_NEXT_WORD:
 			return [[IndirectNextWordOperand alloc] init];
 		case O_NEXT_WORD:
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "OperandArena.h"
+
+@implementation OperandArena
+{
+	NSMutableArray *pools[ARENA_SLOTS];
+	NSUInteger used[ARENA_SLOTS];
+}
+
+- (Operand *)operandOfType:(enum operand_type)type
+{
+	int slot = type == O_NULL ? ARENA_NULL_SLOT : type;
+
+	if(pools[slot] == nil)
+	{
+		pools[slot] = [[NSMutableArray alloc] init];
+	}
+
+	if(used[slot] < [pools[slot] count])
+	{
+		Operand *operand = [pools[slot] objectAtIndex:used[slot]++];
+		operand.registerValue = REG_A;
+		operand.nextWord = 0;
+		operand.value = 0;
+		operand.label = nil;
+		operand.cpuOperations = nil;
+
+		return operand;
+	}
+
+	Operand *operand = [Operand newOperand:type];
+	[pools[slot] addObject:operand];
+	used[slot]++;
+
+	return operand;
+}
+
+- (NSUInteger)count
+{
+	NSUInteger total = 0;
+
+	for(int slot = 0; slot < ARENA_SLOTS; slot++)
+	{
+		total += used[slot];
+	}
+
+	return total;
+}
+
+- (void)reset
+{
+	memset(used, 0, sizeof(used));
+}
+
+- (void)drain
+{
+	for(int slot = 0; slot < ARENA_SLOTS; slot++)
+	{
+		pools[slot] = nil;
+	}
+
+	[self reset];
+}
+
+@end
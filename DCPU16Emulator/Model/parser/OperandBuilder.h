@@ -24,10 +24,14 @@
 #import "Operand.h"
 #import "OperandBuilderProtocol.h"
 
+// Builders keep no state between calls, so one instance of each can be shared by
+// every parse. Operands come from the given arena, or are allocated when it is nil.
 @interface OperandBuilder : NSObject <OperandBuilderProtocol>
 
-@property(nonatomic, strong, readonly) Operand *operand;
-
 - (Operand *)buildFromMatch:(Match *)match;
 
+- (Operand *)buildFromMatch:(Match *)match inArena:(OperandArena *)arena;
+
+- (Operand *)operandOfType:(enum operand_type)type inArena:(OperandArena *)arena;
+
 @end
@@ -21,44 +21,50 @@
  */
 
 #import "OperandBuilder.h"
-
-@interface OperandBuilder ()
-
-@property(nonatomic, strong, readwrite) Operand *operand;
-
-- (Operand *)CreateOperandFromMatch:(Match *)match;
-
-@end
+#import "OperandArena.h"
 
 @implementation OperandBuilder
 
-@synthesize operand;
-
 - (Operand *)buildFromMatch:(Match *)match
 {
-	self.operand = [self CreateOperandFromMatch:match];
+	return [self buildFromMatch:match inArena:nil];
+}
 
-	[self setRegisterValue:match];
-	[self setNextWordValue:match];
-	[self setLabelValue:match];
+- (Operand *)buildFromMatch:(Match *)match inArena:(OperandArena *)arena
+{
+	Operand *operand = [self CreateOperandFromMatch:match inArena:arena];
+
+	[self setRegisterValue:match forOperand:operand];
+	[self setNextWordValue:match forOperand:operand];
+	[self setLabelValue:match forOperand:operand];
 
 	return operand;
 }
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)operandOfType:(enum operand_type)type inArena:(OperandArena *)arena
+{
+	if(arena != nil)
+	{
+		return [arena operandOfType:type];
+	}
+
+	return [Operand newOperand:type];
+}
+
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
 	return nil;
 }
 
-- (void)setRegisterValue:(Match *)match
+- (void)setRegisterValue:(Match *)match forOperand:(Operand *)operand
 {
 }
 
-- (void)setNextWordValue:(Match *)match
+- (void)setNextWordValue:(Match *)match forOperand:(Operand *)operand
 {
 }
 
-- (void)setLabelValue:(Match *)match
+- (void)setLabelValue:(Match *)match forOperand:(Operand *)operand
 {
 }
 
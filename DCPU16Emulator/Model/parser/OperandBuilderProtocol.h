@@ -23,15 +23,17 @@
 #import "Match.h"
 #import "Operand.h"
 
+@class OperandArena;
+
 @protocol OperandBuilderProtocol <NSObject>
 
-- (void)setLabelValue:(Match *)match;
+- (void)setLabelValue:(Match *)match forOperand:(Operand *)operand;
 
-- (void)setNextWordValue:(Match *)match;
+- (void)setNextWordValue:(Match *)match forOperand:(Operand *)operand;
 
-- (void)setRegisterValue:(Match *)match;
+- (void)setRegisterValue:(Match *)match forOperand:(Operand *)operand;
 
 @required
-- (Operand *)CreateOperandFromMatch:(Match *)match;
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena;
 
 @end
@@ -21,96 +21,77 @@
  */
 
 #import "OperandFactory.h"
+#import "OperandBuilder.h"
 #import "RegisterOperandBuilder.h"
 #import "LabelReferenceOperandBuilder.h"
 #import "NextWordOperandBuilder.h"
 #import "IndirectRegisterOperandBuilder.h"
 #import "IndirectNextWordOperandBuilder.h"
+#import "IndirectNextWordOffsetOperandBuilder.h"
 
-typedef Operand *(^creationStrategy)(Match *);
-
-@interface OperandFactory ()
-
-@property(nonatomic, strong) NSDictionary *directOperandCreationStrategyMapper;
-@property(nonatomic, strong) NSDictionary *indirectOperandCreationStrategyMapper;
-
-@end
+#define TOKEN_SLOTS (DIRECTIVE + 1)
 
 @implementation OperandFactory
-
-@synthesize directOperandCreationStrategyMapper;
-@synthesize indirectOperandCreationStrategyMapper;
+{
+	OperandBuilder *directBuilders[TOKEN_SLOTS];
+	OperandBuilder *indirectBuilders[TOKEN_SLOTS];
+	IndirectNextWordOffsetOperandBuilder *offsetBuilder;
+}
 
 - (id)init
 {
 	self = [super init];
-    
-	self.directOperandCreationStrategyMapper = @{
-        @(REGISTER):
-        (Operand *) ^(Match *m)
-        {
-            return [[[RegisterOperandBuilder alloc] init] buildFromMatch:m];
-        },
-        @(LABELREF):
-        (Operand *) ^(Match *m)
-        {
-            return [[[LabelReferenceOperandBuilder alloc] init] buildFromMatch:m];
-        },
-        @(HEX):
-        (Operand *) ^(Match *m)
-        {
-            return [[[NextWordOperandBuilder alloc] init] buildFromMatch:m];
-        },
-        @(INT):
-        (Operand *) ^(Match *m)
-        {
-            return [[[NextWordOperandBuilder alloc] init] buildFromMatch:m];
-        }
-    };
-    
-	self.indirectOperandCreationStrategyMapper = @{
-        @(REGISTER):
-        (Operand *) ^(Match *m)
-        {
-            return [[[IndirectRegisterOperandBuilder alloc] init] buildFromMatch:m];
-        },
-        @(LABELREF):
-        (Operand *) ^(Match *m)
-        {
-            return [[[LabelReferenceOperandBuilder alloc] init] buildFromMatch:m];
-        },
-        @(HEX):
-        (Operand *) ^(Match *m)
-        {
-            return [[[IndirectNextWordOperandBuilder alloc] init] buildFromMatch:m];
-        }
-    };
-    
+
+	OperandBuilder *labelReferenceBuilder = [[LabelReferenceOperandBuilder alloc] init];
+	OperandBuilder *nextWordBuilder = [[NextWordOperandBuilder alloc] init];
+
+	directBuilders[REGISTER] = [[RegisterOperandBuilder alloc] init];
+	directBuilders[LABELREF] = labelReferenceBuilder;
+	directBuilders[HEX] = nextWordBuilder;
+	directBuilders[INT] = nextWordBuilder;
+
+	indirectBuilders[REGISTER] = [[IndirectRegisterOperandBuilder alloc] init];
+	indirectBuilders[LABELREF] = labelReferenceBuilder;
+	indirectBuilders[HEX] = [[IndirectNextWordOperandBuilder alloc] init];
+
+	offsetBuilder = [[IndirectNextWordOffsetOperandBuilder alloc] init];
+
 	return self;
 }
 
 - (Operand *)createDirectOperandForMatch:(Match *)match
 {
-	creationStrategy strategy = [directOperandCreationStrategyMapper objectForKey:[NSNumber numberWithInt:match.token]];
-    
-	if(strategy == nil)
+	return [self createDirectOperandForMatch:match inArena:nil];
+}
+
+- (Operand *)createIndirectOperandForMatch:(Match *)match
+{
+	return [self createIndirectOperandForMatch:match inArena:nil];
+}
+
+- (Operand *)createDirectOperandForMatch:(Match *)match inArena:(OperandArena *)arena
+{
+	if(match.token >= TOKEN_SLOTS || directBuilders[match.token] == nil)
 	{
 		return nil;
 	}
-    
-	return strategy(match);
+
+	return [directBuilders[match.token] buildFromMatch:match inArena:arena];
 }
 
-- (Operand *)createIndirectOperandForMatch:(Match *)match
+- (Operand *)createIndirectOperandForMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	creationStrategy strategy = [indirectOperandCreationStrategyMapper objectForKey:[NSNumber numberWithInt:match.token]];
-    
-	if(strategy == nil)
+	if(match.token >= TOKEN_SLOTS || indirectBuilders[match.token] == nil)
 	{
 		return nil;
 	}
-    
-	return strategy(match);
+
+	return [indirectBuilders[match.token] buildFromMatch:match inArena:arena];
+}
+
+- (Operand *)createIndirectOffsetOperandForMatch:(Match *)match leftToken:(Match *)leftToken inArena:(OperandArena *)arena
+{
+	return [offsetBuilder buildFromMatch:match withLeftToken:leftToken inArena:arena];
 }
 
 @end
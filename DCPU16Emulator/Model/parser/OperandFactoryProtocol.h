@@ -23,10 +23,18 @@
 #import "Operand.h"
 #import "Match.h"
 
+@class OperandArena;
+
 @protocol OperandFactoryProtocol <NSObject>
 
 - (Operand *)createDirectOperandForMatch:(Match *)match;
 
 - (Operand *)createIndirectOperandForMatch:(Match *)match;
 
+- (Operand *)createDirectOperandForMatch:(Match *)match inArena:(OperandArena *)arena;
+
+- (Operand *)createIndirectOperandForMatch:(Match *)match inArena:(OperandArena *)arena;
+
+- (Operand *)createIndirectOffsetOperandForMatch:(Match *)match leftToken:(Match *)leftToken inArena:(OperandArena *)arena;
+
 @end
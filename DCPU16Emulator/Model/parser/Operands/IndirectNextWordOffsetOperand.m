@@ -49,4 +49,9 @@
 	return (O_INDIRECT_NEXT_WORD_OFFSET + self.registerValue) << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_INDIRECT_NEXT_WORD_OFFSET;
+}
+
 @end
@@ -24,6 +24,6 @@
 
 @interface IndirectNextWordOffsetOperandBuilder : RegisterOperandBuilder
 
-- (id)initWithLeftToken:(Match *)leftToken;
+- (Operand *)buildFromMatch:(Match *)match withLeftToken:(Match *)leftToken inArena:(OperandArena *)arena;
 
 @end
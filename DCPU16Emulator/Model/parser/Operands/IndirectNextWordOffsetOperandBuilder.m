@@ -24,33 +24,19 @@
 #import "IndirectNextWordOffsetOperandBuilder.h"
 #import "NSString+ParseHex_ParseInt.h"
 
-@interface IndirectNextWordOffsetOperandBuilder ()
-
-@property(nonatomic, strong) Match *leftToken;
-
-@end
-
 @implementation IndirectNextWordOffsetOperandBuilder
 
-@synthesize leftToken;
-
-- (id)initWithLeftToken:(Match *)token
+- (Operand *)buildFromMatch:(Match *)match withLeftToken:(Match *)leftToken inArena:(OperandArena *)arena
 {
-	self = [super init];
+	Operand *operand = [self buildFromMatch:match inArena:arena];
+	operand.nextWord = [leftToken.content parseHexLiteral];
 
-	self.leftToken = token;
-
-	return self;
-}
-
-- (Operand *)CreateOperandFromMatch:(Match *)match
-{
-	return [[IndirectNextWordOffsetOperand alloc] init];
+	return operand;
 }
 
-- (void)setNextWordValue:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	self.operand.nextWord = [leftToken.content parseHexLiteral];
+	return [self operandOfType:O_INDIRECT_NEXT_WORD_OFFSET inArena:arena];
 }
 
 @end
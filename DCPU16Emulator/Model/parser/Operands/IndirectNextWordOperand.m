@@ -53,4 +53,9 @@
 	}
 }
 
+- (enum operand_type)operandType
+{
+	return O_INDIRECT_NEXT_WORD;
+}
+
 @end
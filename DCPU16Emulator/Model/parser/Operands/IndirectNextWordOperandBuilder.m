@@ -26,20 +26,20 @@
 
 @implementation IndirectNextWordOperandBuilder
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	return [[IndirectNextWordOperand alloc] init];
+	return [self operandOfType:O_INDIRECT_NEXT_WORD inArena:arena];
 }
 
-- (void)setNextWordValue:(Match *)match
+- (void)setNextWordValue:(Match *)match forOperand:(Operand *)operand
 {
 	if(match.token == HEX)
 	{
-		self.operand.nextWord = [match.content parseHexLiteral];
+		operand.nextWord = [match.content parseHexLiteral];
 	}
 	else if(match.token == INT)
 	{
-		self.operand.nextWord = [match.content parseDecimalLiteral];
+		operand.nextWord = [match.content parseDecimalLiteral];
 	}
 }
 
@@ -42,4 +42,9 @@
 	return (O_INDIRECT_REG + self.registerValue) << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_INDIRECT_REG;
+}
+
 @end
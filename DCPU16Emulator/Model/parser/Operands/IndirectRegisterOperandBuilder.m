@@ -25,9 +25,9 @@
 
 @implementation IndirectRegisterOperandBuilder
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	return [[IndirectRegisterOperand alloc] init];
+	return [self operandOfType:O_INDIRECT_REG inArena:arena];
 }
 
 @end
@@ -25,18 +25,18 @@
 
 @implementation LabelReferenceOperandBuilder
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	return [[NextWordOperand alloc] init];
+	return [self operandOfType:O_NEXT_WORD inArena:arena];
 }
 
-- (void)setNextWordValue:(Match *)match
+- (void)setNextWordValue:(Match *)match forOperand:(Operand *)operand
 {
-	self.operand.nextWord = 0;
+	operand.nextWord = 0;
 }
 
-- (void)setLabelValue:(Match *)match
+- (void)setLabelValue:(Match *)match forOperand:(Operand *)operand
 {
-	self.operand.label = match.content;
+	operand.label = match.content;
 }
 @end
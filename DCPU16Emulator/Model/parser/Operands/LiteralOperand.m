@@ -30,4 +30,9 @@
 	return value;
 }
 
+- (enum operand_type)operandType
+{
+	return O_LITERAL;
+}
+
 @end
@@ -47,4 +47,9 @@
 	}
 }
 
+- (enum operand_type)operandType
+{
+	return O_NEXT_WORD;
+}
+
 @end
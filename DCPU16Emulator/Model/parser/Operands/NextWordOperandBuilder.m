@@ -26,20 +26,20 @@
 
 @implementation NextWordOperandBuilder
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
-	return [[NextWordOperand alloc] init];
+	return [self operandOfType:O_NEXT_WORD inArena:arena];
 }
 
-- (void)setNextWordValue:(Match *)match
+- (void)setNextWordValue:(Match *)match forOperand:(Operand *)operand
 {
 	if(match.token == HEX)
 	{
-		self.operand.nextWord = [match.content parseHexLiteral];
+		operand.nextWord = [match.content parseHexLiteral];
 	}
 	else if(match.token == INT)
 	{
-		self.operand.nextWord = [match.content parseDecimalLiteral];
+		operand.nextWord = [match.content parseDecimalLiteral];
 	}
 }
 
@@ -39,4 +39,9 @@
 	return O_O << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_O;
+}
+
 @end
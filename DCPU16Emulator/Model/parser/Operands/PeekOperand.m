@@ -34,4 +34,9 @@
 	return O_PEEK << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_PEEK;
+}
+
 @end
@@ -37,4 +37,9 @@
 	return O_POP << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_POP;
+}
+
 @end
@@ -39,4 +39,9 @@
 	return O_PC << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_PC;
+}
+
 @end
@@ -34,4 +34,9 @@
 	return O_PUSH << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_PUSH;
+}
+
 @end
@@ -40,6 +40,11 @@
 	return (O_REG + self.registerValue) << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_REG;
+}
+
 + (NSString *)registerNameForIdentifier:(ushort)identifier
 {
 	if(identifier == REG_A)
@@ -21,50 +21,45 @@
  */
 
 #import "RegisterOperandBuilder.h"
-#import "ProgramCounterOperand.h"
-#import "StackPointerOperand.h"
-#import "OverflowOperand.h"
-#import "PeekOperand.h"
-#import "PushOperand.h"
-#import "PopOperand.h"
+#import "RegisterOperand.h"
 
 @implementation RegisterOperandBuilder
 
-- (Operand *)CreateOperandFromMatch:(Match *)match
+- (Operand *)CreateOperandFromMatch:(Match *)match inArena:(OperandArena *)arena
 {
 	NSString *operandName = [match.content uppercaseString];
 
 	if([operandName isEqualToString:@"PC"])
 	{
-		return [[ProgramCounterOperand alloc] init];
+		return [self operandOfType:O_PC inArena:arena];
 	}
 	if([operandName isEqualToString:@"SP"])
 	{
-		return [[StackPointerOperand alloc] init];
+		return [self operandOfType:O_SP inArena:arena];
 	}
 	if([operandName isEqualToString:@"O"])
 	{
-		return [[OverflowOperand alloc] init];
+		return [self operandOfType:O_O inArena:arena];
 	}
 	if([operandName isEqualToString:@"POP"])
 	{
-		return [[PopOperand alloc] init];
+		return [self operandOfType:O_POP inArena:arena];
 	}
 	if([operandName isEqualToString:@"PEEK"])
 	{
-		return [[PeekOperand alloc] init];
+		return [self operandOfType:O_PEEK inArena:arena];
 	}
 	if([operandName isEqualToString:@"PUSH"])
 	{
-		return [[PushOperand alloc] init];
+		return [self operandOfType:O_PUSH inArena:arena];
 	}
 
-	return [[RegisterOperand alloc] init];
+	return [self operandOfType:O_REG inArena:arena];
 }
 
-- (void)setRegisterValue:(Match *)match
+- (void)setRegisterValue:(Match *)match forOperand:(Operand *)operand
 {
-	self.operand.registerValue = (enum operand_register_value) [RegisterOperand registerIdentifierForName:match.content];
+	operand.registerValue = (enum operand_register_value) [RegisterOperand registerIdentifierForName:match.content];
 }
 
 @end
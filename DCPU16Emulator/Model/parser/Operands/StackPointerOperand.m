@@ -39,4 +39,9 @@
 	return O_SP << shift;
 }
 
+- (enum operand_type)operandType
+{
+	return O_SP;
+}
+
 @end
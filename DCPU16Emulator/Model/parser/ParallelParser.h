@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "ParserProtocol.h"
+
+#define DEFAULT_LINES_PER_CHUNK 1024
+
+@protocol LexerProtocol;
+
+typedef id <LexerProtocol>(^createLexer)();
+
+// Splits a source at line boundaries and parses the chunks concurrently, each with its
+// own Parser and lexer, then concatenates the statments in source order. Errors carry
+// the line numbers of the whole source. A chunk never starts right after a line that
+// holds nothing but a label, so labels stay attached to their statment.
+@interface ParallelParser : NSObject <ParserProtocol>
+
+@property(nonatomic, assign) NSUInteger linesPerChunk;
+
+// Builds the lexer of every chunk after the first, which uses the lexer handed to
+// parseSource:withLexer:. Defaults to a Lexer that ignores whitespace.
+@property(nonatomic, copy) createLexer lexerFactory;
+
+@end
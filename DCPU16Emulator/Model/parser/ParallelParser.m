@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "ParallelParser.h"
+#import "Parser.h"
+#import "OperandFactory.h"
+#import "Statment.h"
+#import "StatmentTable.h"
+#import "ParseDiagnostic.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+
+@interface ParallelParser ()
+
+@property(nonatomic, strong) id <OperandFactoryProtocol> operandFactory;
+@property(nonatomic, strong) NSMutableArray *internalDiagnostics;
+
+@end
+
+@implementation ParallelParser
+{
+	dispatch_queue_t q_default;
+}
+
+@synthesize statments;
+@synthesize didFinishParsingSuccessfully;
+@synthesize didFinishParsingWithError;
+@synthesize includeDirectory;
+@synthesize linesPerChunk;
+@synthesize lexerFactory;
+@synthesize operandFactory;
+@synthesize recoverFromErrors;
+@synthesize didFinishParsingWithDiagnostics;
+@synthesize internalDiagnostics;
+
+- (id)init
+{
+	return [self initWithOperandFactory:[[OperandFactory alloc] init]];
+}
+
+- (id)initWithOperandFactory:(id <OperandFactoryProtocol>)factory
+{
+	self = [super init];
+
+	self.operandFactory = factory;
+	self.linesPerChunk = DEFAULT_LINES_PER_CHUNK;
+	self.lexerFactory = ^
+	{
+		return (id <LexerProtocol>) [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														   consumeTokenStrategy:[[ConsumeToken alloc] init]];
+	};
+	q_default = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+	return self;
+}
+
+- (NSArray *)diagnostics
+{
+	return self.internalDiagnostics;
+}
+
+- (void)parseSource:(NSString *)source withLexer:(id <LexerProtocol>)theLexer
+{
+	[self parseSource:source withLexer:theLexer intoTable:nil];
+}
+
+- (void)parseSource:(NSString *)source withLexer:(id <LexerProtocol>)theLexer intoTable:(StatmentTable *)table
+{
+	NSMutableArray *chunkRanges = [[NSMutableArray alloc] init];
+	NSMutableArray *chunkFirstLines = [[NSMutableArray alloc] init];
+
+	[self splitSource:source intoRanges:chunkRanges firstLines:chunkFirstLines];
+
+	NSUInteger chunkCount = [chunkRanges count];
+	NSMutableArray *chunkStatments = [[NSMutableArray alloc] initWithCapacity:chunkCount];
+	NSMutableArray *chunkErrors = [[NSMutableArray alloc] initWithCapacity:chunkCount];
+	NSMutableArray *chunkDiagnostics = [[NSMutableArray alloc] initWithCapacity:chunkCount];
+
+	for(NSUInteger i = 0; i < chunkCount; i++)
+	{
+		[chunkStatments addObject:[NSNull null]];
+		[chunkErrors addObject:[NSNull null]];
+		[chunkDiagnostics addObject:[NSArray array]];
+	}
+
+	dispatch_apply(chunkCount, q_default, ^(size_t chunk)
+	{
+		Parser *parser = [[Parser alloc] initWithOperandFactory:self.operandFactory];
+		parser.firstLineNumber = [[chunkFirstLines objectAtIndex:chunk] intValue];
+		parser.includeDirectory = self.includeDirectory;
+		parser.recoverFromErrors = self.recoverFromErrors;
+		parser.didFinishParsingWithDiagnostics = ^(NSArray *found)
+		{
+			@synchronized(chunkDiagnostics)
+			{
+				[chunkDiagnostics replaceObjectAtIndex:chunk withObject:found];
+			}
+		};
+		parser.didFinishParsingWithError = ^(NSString *message)
+		{
+			@synchronized(chunkErrors)
+			{
+				[chunkErrors replaceObjectAtIndex:chunk withObject:message];
+			}
+		};
+
+		id <LexerProtocol> lexer = chunk == 0 ? theLexer : self.lexerFactory();
+		NSString *text = [source substringWithRange:[[chunkRanges objectAtIndex:chunk] rangeValue]];
+
+		[parser parseSource:text withLexer:lexer];
+
+		@synchronized(chunkStatments)
+		{
+			[chunkStatments replaceObjectAtIndex:chunk withObject:parser.statments];
+		}
+	});
+
+	self.statments = [[NSMutableArray alloc] init];
+	self.internalDiagnostics = [[NSMutableArray alloc] init];
+
+	for(NSArray *found in chunkDiagnostics)
+	{
+		[self.internalDiagnostics addObjectsFromArray:found];
+	}
+
+	for(NSUInteger i = 0; i < chunkCount; i++)
+	{
+		id message = [chunkErrors objectAtIndex:i];
+
+		if(message != [NSNull null])
+		{
+			[self reportError:message];
+			return;
+		}
+	}
+
+	for(NSArray *parsed in chunkStatments)
+	{
+		if(table != nil)
+		{
+			for(Statment *statment in parsed)
+			{
+				[table addStatment:statment];
+			}
+		}
+		else
+		{
+			[self.statments addObjectsFromArray:parsed];
+		}
+	}
+
+	if([self.internalDiagnostics count] > 0)
+	{
+		if(self.didFinishParsingWithDiagnostics)
+		{
+			self.didFinishParsingWithDiagnostics(self.internalDiagnostics);
+			return;
+		}
+
+		[self reportError:[[self.internalDiagnostics objectAtIndex:0] message]];
+		return;
+	}
+
+	if(self.didFinishParsingSuccessfully)
+	{
+		self.didFinishParsingSuccessfully();
+	}
+}
+
+- (void)reportError:(NSString *)message
+{
+	if(self.didFinishParsingWithError)
+	{
+		self.didFinishParsingWithError(message);
+		return;
+	}
+
+	@throw message;
+}
+
+- (void)splitSource:(NSString *)source intoRanges:(NSMutableArray *)ranges firstLines:(NSMutableArray *)firstLines
+{
+	NSUInteger length = [source length];
+	unichar *characters = malloc(MAX(length, 1) * sizeof(unichar));
+	[source getCharacters:characters range:NSMakeRange(0, length)];
+
+	NSUInteger chunkStart = 0;
+	NSUInteger chunkFirstLine = 0;
+	NSUInteger lineStart = 0;
+	NSUInteger line = 0;
+	NSUInteger chunkLines = MAX(self.linesPerChunk, 1);
+
+	// Set by a label-only line until a line with a statment follows, so that blank and
+	// comment lines between a label and its instruction never end up at a cut.
+	BOOL pendingLabel = NO;
+
+	for(NSUInteger i = 0; i < length; i++)
+	{
+		if(characters[i] != '\n')
+		{
+			continue;
+		}
+
+		line++;
+
+		if([self isLabelOnlyLine:characters + lineStart length:i - lineStart])
+		{
+			pendingLabel = YES;
+		}
+		else if(![self isBlankOrCommentLine:characters + lineStart length:i - lineStart])
+		{
+			pendingLabel = NO;
+		}
+
+		lineStart = i + 1;
+
+		if(line - chunkFirstLine >= chunkLines && !pendingLabel)
+		{
+			[ranges addObject:[NSValue valueWithRange:NSMakeRange(chunkStart, lineStart - chunkStart)]];
+			[firstLines addObject:[NSNumber numberWithUnsignedInteger:chunkFirstLine]];
+			chunkStart = lineStart;
+			chunkFirstLine = line;
+		}
+	}
+
+	if(chunkStart < length || [ranges count] == 0)
+	{
+		[ranges addObject:[NSValue valueWithRange:NSMakeRange(chunkStart, length - chunkStart)]];
+		[firstLines addObject:[NSNumber numberWithUnsignedInteger:chunkFirstLine]];
+	}
+
+	free(characters);
+}
+
+- (BOOL)isBlankOrCommentLine:(const unichar *)line length:(NSUInteger)length
+{
+	NSUInteger i = 0;
+
+	while(i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+	{
+		i++;
+	}
+
+	return i == length || line[i] == ';';
+}
+
+- (BOOL)isLabelOnlyLine:(const unichar *)line length:(NSUInteger)length
+{
+	NSUInteger i = 0;
+
+	while(i < length && (line[i] == ' ' || line[i] == '\t'))
+	{
+		i++;
+	}
+
+	if(i == length || line[i] != ':')
+	{
+		return NO;
+	}
+
+	i++;
+
+	while(i < length && ((line[i] < 128 && isalnum(line[i])) || line[i] == '_'))
+	{
+		i++;
+	}
+
+	while(i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+	{
+		i++;
+	}
+
+	return i == length || line[i] == ';';
+}
+
+@end
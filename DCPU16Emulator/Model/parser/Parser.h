@@ -22,9 +22,31 @@
 
 #import "OperandFactoryProtocol.h"
 #import "ParserProtocol.h"
+#import "PipelineStats.h"
 
 @protocol LexerProtocol;
+@class OperandArena;
+
+typedef BOOL(^parseShouldCancel)();
 
 @interface Parser : NSObject <ParserProtocol>
 
+// Number of source lines that precede the parsed text, so a chunk of a larger
+// source reports errors with the line numbers of the whole file.
+@property(nonatomic, assign) int firstLineNumber;
+
+// Owns the operands of the parsed statments; drain it once they have been assembled.
+// When parsing into a StatmentTable the arena is recycled after every statment.
+@property(nonatomic, strong, readonly) OperandArena *operandArena;
+
+// Checked between statments; once it returns YES parsing stops, wasCancelled is set
+// and none of the completion blocks are called.
+@property(nonatomic, copy) parseShouldCancel shouldCancel;
+@property(nonatomic, readonly) BOOL wasCancelled;
+
+// Accumulates over parses until reset; lexer counters stay with the lexer.
+@property(nonatomic, readonly) struct pipeline_stats stats;
+
+- (void)resetStats;
+
 @end
@@ -23,15 +23,23 @@
 #import "LexerProtocol.h"
 #import "OperandFactory.h"
 #import "Statment.h"
+#import "StatmentTable.h"
+#import "ParseDiagnostic.h"
 #import "PeekToken.h"
 #import "NSString+ParseHex_ParseInt.h"
-#import "IndirectNextWordOffsetOperandBuilder.h"
+#import "OperandArena.h"
 
 @interface Parser ()
 
 @property(nonatomic, strong) id <LexerProtocol> lexer;
 @property(nonatomic, strong) id <ConsumeTokenStrategy> peekToken;
 @property(nonatomic, strong) id <OperandFactoryProtocol> operandFactory;
+@property(nonatomic, strong) StatmentTable *statmentTable;
+@property(nonatomic, strong) NSMutableArray *internalDiagnostics;
+@property(nonatomic, assign) int statmentLineNumber;
+@property(nonatomic, strong, readwrite) OperandArena *operandArena;
+@property(nonatomic, strong) Match *leftToken;
+@property(nonatomic, readwrite) BOOL wasCancelled;
 
 @end
 
@@ -42,17 +50,25 @@
 
 @synthesize peekToken;
 @synthesize operandFactory;
+@synthesize statmentTable;
 
 @synthesize didFinishParsingSuccessfully;
 @synthesize didFinishParsingWithError;
+@synthesize includeDirectory;
+@synthesize firstLineNumber;
+@synthesize recoverFromErrors;
+@synthesize internalDiagnostics;
+@synthesize didFinishParsingWithDiagnostics;
+@synthesize statmentLineNumber;
+@synthesize operandArena;
+@synthesize leftToken;
+@synthesize shouldCancel;
+@synthesize wasCancelled;
+@synthesize stats;
 
 - (id)init
 {
-    self = [super init];
-    
-	self.operandFactory = [[OperandFactory init] alloc];;
-    
-	return self;
+	return [self initWithOperandFactory:[[OperandFactory alloc] init]];
 }
 
 - (id)initWithOperandFactory:(id <OperandFactoryProtocol>)factory
@@ -60,22 +76,68 @@
 	self = [super init];
 
 	self.operandFactory = factory;
+	self.operandArena = [[OperandArena alloc] init];
+	self.leftToken = [[Match alloc] init];
 
 	return self;
 }
 
 - (void)parseSource:(NSString *)source withLexer:(id<LexerProtocol>)theLexer
 {
+	[self parseSource:source withLexer:theLexer intoTable:nil];
+}
+
+- (void)resetStats
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+- (void)parseSource:(NSString *)source withLexer:(id<LexerProtocol>)theLexer intoTable:(StatmentTable *)table
+{
+	PIPELINE_STATS_START(start);
+
+	@try
+	{
+		[self parseAllStatmentsOfSource:source withLexer:theLexer intoTable:table];
+	}
+	@finally
+	{
+		PIPELINE_STATS_STOP(stats, parseTime, start);
+	}
+}
+
+- (void)parseAllStatmentsOfSource:(NSString *)source withLexer:(id<LexerProtocol>)theLexer intoTable:(StatmentTable *)table
+{
+	self.statmentTable = table;
 	self.lexer = theLexer;
 	self.peekToken = [[PeekToken alloc] init];
 	self.statments = [[NSMutableArray alloc] init];
+	self.internalDiagnostics = [[NSMutableArray alloc] init];
+	self.wasCancelled = NO;
 
-	[self.lexer lexSource:source];
+	[self.operandArena drain];
+	[self.lexer lexSource:source startingAtLine:self.firstLineNumber];
 
 	@try
 	{
-		while([self parseStatment])
+		while([self parseStatmentRecoveringFromErrors])
+		{
+			if(self.shouldCancel != nil && self.shouldCancel())
+			{
+				self.wasCancelled = YES;
+				return;
+			}
+		}
+
+		if([self.diagnostics count] > 0)
 		{
+			if(self.didFinishParsingWithDiagnostics)
+			{
+				self.didFinishParsingWithDiagnostics(self.diagnostics);
+				return;
+			}
+
+			@throw [[self.diagnostics objectAtIndex:0] message];
 		}
 
 		if(self.didFinishParsingSuccessfully)
@@ -96,6 +158,46 @@
 	}
 }
 
+- (NSArray *)diagnostics
+{
+	return self.internalDiagnostics;
+}
+
+- (BOOL)parseStatmentRecoveringFromErrors
+{
+	if(!self.recoverFromErrors)
+	{
+		return [self parseStatment];
+	}
+
+	@try
+	{
+		return [self parseStatment];
+	}
+	@catch(NSString *message)
+	{
+		[self addDiagnosticWithMessage:message];
+
+		// The lexer may already sit at the start of the next line when the offending
+		// token ended the statment's line; only skip what is left of a broken line.
+		if(self.lexer.lineNumber == self.statmentLineNumber || self.lexer.columnNumber > 0)
+		{
+			[self.lexer skipLine];
+		}
+
+		return YES;
+	}
+}
+
+- (void)addDiagnosticWithMessage:(NSString *)message
+{
+	NSRange range = NSMakeRange((NSUInteger) self.lexer.tokenColumnNumber, (NSUInteger) self.lexer.tokenLength);
+
+	[self.internalDiagnostics addObject:[[ParseDiagnostic alloc] initWithLine:self.lexer.tokenLineNumber
+														   tokenRange:range
+															  message:message]];
+}
+
 - (BOOL)parseStatment
 {
 	Statment *statment = [[Statment alloc] init];
@@ -109,15 +211,38 @@
 		return NO;
 	}
 
+	self.statmentLineNumber = self.lexer.lineNumber;
+	statment.lineNumber = self.statmentLineNumber;
+
 	[self parseLabelForStatment:statment];
 	[self parseMenemonicForStatment:statment];
-    [self parseOperandsForStatment:statment];
-	[self.statments addObject:statment];
+
+	if(!statment.isData)
+	{
+		[self parseOperandsForStatment:statment];
+	}
+
+	[self emitStatment:statment];
 	[self parseComments];
 
 	return YES;
 }
 
+- (void)emitStatment:(Statment *)statment
+{
+	PIPELINE_STATS_ADD(stats, allocations, 1);
+
+	if(self.statmentTable != nil)
+	{
+		[self.statmentTable addStatment:statment];
+		[self.operandArena reset];
+	}
+	else
+	{
+		[self.statments addObject:statment];
+	}
+}
+
 - (void)parseEmptyLines
 {
 	[self.lexer nextTokenUsingStrategy:(self.peekToken)];
@@ -161,6 +286,13 @@
 {
 	[self.lexer nextToken];
 
+	if(self.lexer.token == DIRECTIVE)
+	{
+		statment.menemonic = [self.lexer.tokenContents uppercaseString];
+		[self parseBinaryInclude:statment];
+		return;
+	}
+
 	if(self.lexer.token != INSTRUCTION)
 	{
 		@throw [NSString stringWithFormat:@"Expected INSTRUCTION at line %d:%d found '%@'", self.lexer.lineNumber, self.lexer.columnNumber, self.lexer.tokenContents];
@@ -186,7 +318,7 @@
 	}
 	else
 	{
-		statment.secondOperand = [Operand newOperand:O_NULL];
+		statment.secondOperand = [self.operandArena operandOfType:O_NULL];
 	}
 }
 
@@ -199,7 +331,7 @@
 		return [self parseIndirectOperand];
 	}
 
-	Operand *operand = [self.operandFactory createDirectOperandForMatch:self.lexer.match];
+	Operand *operand = [self.operandFactory createDirectOperandForMatch:self.lexer.match inArena:self.operandArena];
 
 	if(operand == nil)
 	{
@@ -213,9 +345,8 @@
 {
 	[self.lexer nextToken];
 
-	Match *leftToken = [[Match alloc] init];
-	leftToken.token = self.lexer.token;
-	leftToken.content = [self.lexer.tokenContents copy];
+	self.leftToken.token = self.lexer.token;
+	self.leftToken.content = self.lexer.tokenContents;
 
 	Operand *operand;
 
@@ -224,11 +355,11 @@
 	if(self.lexer.token == PLUS)
 	{
 		[self.lexer nextToken];
-		operand = [self parseIndirectOffsetOperand:leftToken];
+		operand = [self parseIndirectOffsetOperand:self.leftToken];
 	}
 	else
 	{
-		operand = [self.operandFactory createIndirectOperandForMatch:leftToken];
+		operand = [self.operandFactory createIndirectOperandForMatch:self.leftToken inArena:self.operandArena];
 	}
 
 	[self assertIndirectOperandIsTerminatedWithACloseBracketToken];
@@ -241,8 +372,9 @@
 {
 	[self.lexer nextToken];
 
-	return [[[IndirectNextWordOffsetOperandBuilder alloc] initWithLeftToken:previousMatch]
-												   buildFromMatch:self.lexer.match];
+	return [self.operandFactory createIndirectOffsetOperandForMatch:self.lexer.match
+														  leftToken:previousMatch
+															inArena:self.operandArena];
 }
 
 - (void)assertIndirectOperandIsTerminatedWithACloseBracketToken
@@ -276,15 +408,7 @@
 		}
 		else if(self.lexer.token == STRING)
 		{
-			int len = [self.lexer.tokenContents length];
-			unichar buffer[len];
-			[self.lexer.tokenContents getCharacters:buffer range:NSMakeRange(0, (NSUInteger) len)];
-
-			for(int i = 0; i < len; ++i)
-			{
-				char current = (char) buffer[i];
-				[statment addDat:(UInt16) current];
-			}
+			[statment addDatCharacters:self.lexer.tokenContents];
 		}
 
 		[self.lexer nextTokenUsingStrategy:(self.peekToken)];
@@ -292,4 +416,43 @@
 	} while(self.lexer.token == COMMA);
 }
 
+- (void)parseBinaryInclude:(Statment *)statment
+{
+	[self.lexer nextToken];
+
+	if(self.lexer.token != STRING)
+	{
+		@throw [NSString stringWithFormat:@"Expected STRING at line %d:%d found '%@'", self.lexer.lineNumber, self.lexer.columnNumber, self.lexer.tokenContents];
+	}
+
+	NSString *path = self.lexer.tokenContents;
+
+	if([path hasPrefix:@"@"])
+	{
+		path = [path substringFromIndex:1];
+	}
+
+	path = [path substringWithRange:NSMakeRange(1, [path length] - 2)];
+
+	if(![path isAbsolutePath] && self.includeDirectory != nil)
+	{
+		path = [self.includeDirectory stringByAppendingPathComponent:path];
+	}
+
+	NSError *error = nil;
+	NSData *contents = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:&error];
+
+	if(contents == nil)
+	{
+		@throw [NSString stringWithFormat:@"Cannot read '%@' at line %d:%d", path, self.lexer.lineNumber, self.lexer.columnNumber];
+	}
+
+	if([contents length] % sizeof(UInt16) != 0)
+	{
+		@throw [NSString stringWithFormat:@"Odd byte count in '%@' at line %d:%d", path, self.lexer.lineNumber, self.lexer.columnNumber];
+	}
+
+	statment.binaryInclude = contents;
+}
+
 @end
@@ -23,11 +23,14 @@
 #import "Parser.h"
 
 @protocol LexerProtocol;
+@class StatmentTable;
 
 typedef void(^parseCompletedSuccessfully)();
 
 typedef void(^parseFailedWithError)(NSString *);
 
+typedef void(^parseFailedWithDiagnostics)(NSArray *);
+
 @protocol ParserProtocol <NSObject>
 
 @property(nonatomic, strong) NSMutableArray *statments;
@@ -36,8 +39,20 @@ typedef void(^parseFailedWithError)(NSString *);
 
 @property(nonatomic, copy) parseFailedWithError didFinishParsingWithError;
 
+@property(nonatomic, copy) NSString *includeDirectory;
+
+// When set, an error skips the rest of its line and parsing carries on; every error
+// is kept as a ParseDiagnostic and reported once the whole source has been read.
+@property(nonatomic, assign) BOOL recoverFromErrors;
+
+@property(nonatomic, strong, readonly) NSArray *diagnostics;
+
+@property(nonatomic, copy) parseFailedWithDiagnostics didFinishParsingWithDiagnostics;
+
 - (id)initWithOperandFactory:(id <OperandFactoryProtocol>)factory;
 
 - (void)parseSource:(NSString *)source withLexer:(id <LexerProtocol>)theLexer;
 
+- (void)parseSource:(NSString *)source withLexer:(id <LexerProtocol>)theLexer intoTable:(StatmentTable *)table;
+
 @end
\ No newline at end of file
@@ -53,13 +53,18 @@ typedef enum non_basic_opcode nonBasicOpcode;
 @interface Statment : NSObject
 
 @property(nonatomic, strong) NSString *label;
+@property(nonatomic, assign) int lineNumber;
 @property(nonatomic, strong) NSString *menemonic;
 @property(nonatomic, assign) basicOpcode opcode;
 @property(nonatomic, assign) nonBasicOpcode opcodeNonBasic;
 @property(nonatomic, strong) Operand *firstOperand;
 @property(nonatomic, strong) Operand *secondOperand;
-@property(nonatomic, readonly) NSArray *dat;
+@property(nonatomic, readonly) NSData *dat;
+@property(nonatomic, strong) NSData *binaryInclude;
+@property(nonatomic, readonly) BOOL isData;
 
 - (void)addDat:(UInt16)value;
 
+- (void)addDatCharacters:(NSString *)characters;
+
 @end
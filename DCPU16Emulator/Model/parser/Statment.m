@@ -25,7 +25,7 @@
 @interface Statment ()
 
 @property(nonatomic, strong) NSString *internalMenemonic;
-@property(nonatomic, strong) NSMutableArray *internalDat;
+@property(nonatomic, strong) NSMutableData *internalDat;
 
 - (void)setOpcodeForMenemonic;
 
@@ -34,24 +34,47 @@
 @implementation Statment
 
 @synthesize label;
+@synthesize lineNumber;
 @synthesize opcode;
 @synthesize opcodeNonBasic;
 @synthesize firstOperand;
 @synthesize secondOperand;
+@synthesize binaryInclude;
 
-- (NSArray *)dat
+- (NSData *)dat
 {
 	return self.internalDat;
 }
 
+- (BOOL)isData
+{
+	return [self.menemonic isEqualToString:@"DAT"] || [self.menemonic isEqualToString:@".INCBIN"];
+}
+
 - (void)addDat:(UInt16)value
 {
 	if(self.internalDat == nil)
 	{
-		self.internalDat = [[NSMutableArray alloc] init];
+		self.internalDat = [[NSMutableData alloc] init];
+	}
+
+	[self.internalDat appendBytes:&value length:sizeof(UInt16)];
+}
+
+- (void)addDatCharacters:(NSString *)characters
+{
+	if(self.internalDat == nil)
+	{
+		self.internalDat = [[NSMutableData alloc] init];
 	}
 
-	[self.internalDat addObject:[NSNumber numberWithInt:value]];
+	NSUInteger length = [characters length];
+	NSUInteger offset = [self.internalDat length];
+
+	[self.internalDat increaseLengthBy:length * sizeof(UInt16)];
+
+	unichar *words = (unichar *) ((uint8_t *) [self.internalDat mutableBytes] + offset);
+	[characters getCharacters:words range:NSMakeRange(0, length)];
 }
 
 - (NSString *)menemonic
@@ -134,7 +157,7 @@
 		self.opcode = (basicOpcode) 0x0;
 		self.opcodeNonBasic = OP_JSR;
 	}
-	else if([self.menemonic isEqualToString:@"DAT"])
+	else if([self.menemonic isEqualToString:@"DAT"] || [self.menemonic isEqualToString:@".INCBIN"])
 	{
 		self.opcode = (basicOpcode) 0x0;
 	}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "Statment.h"
+#import "SymbolTable.h"
+
+#define NO_INCLUDE -1
+
+#define FIRST_OPERAND 0
+#define SECOND_OPERAND 1
+
+// Struct-of-arrays form of a parsed program. Each statment is a row index into parallel
+// columns, operand labels are interned into dense symbol ids and DAT words are packed
+// into a single arena, so encoding a program is a linear scan with no object traffic.
+@interface StatmentTable : NSObject
+
+@property(nonatomic, readonly) NSUInteger count;
+@property(nonatomic, readonly) NSUInteger symbolCount;
+@property(nonatomic, strong, readonly) SymbolTable *symbols;
+
+@property(nonatomic, readonly) const uint8_t *opcodes;
+@property(nonatomic, readonly) const uint8_t *opcodesNonBasic;
+@property(nonatomic, readonly) const int32_t *labels;
+@property(nonatomic, readonly) const int32_t *lineNumbers;
+@property(nonatomic, readonly) const uint32_t *datOffsets;
+@property(nonatomic, readonly) const uint32_t *datLengths;
+@property(nonatomic, readonly) const uint16_t *datArena;
+
++ (StatmentTable *)tableWithStatments:(NSArray *)statments;
+
+// Interns labels into an existing symbol table, so ids stay stable across tables.
+- (id)initWithSymbolTable:(SymbolTable *)symbolTable;
+
+- (void)addStatment:(Statment *)statment;
+
+// Mapped contents of a .incbin row as big-endian words, nil for any other row.
+- (NSData *)binaryIncludeForRow:(NSUInteger)row;
+
+- (const uint16_t *)operandKindsForOperand:(int)operandIndex;
+
+- (const uint8_t *)operandRegistersForOperand:(int)operandIndex;
+
+- (const uint16_t *)operandNextWordsForOperand:(int)operandIndex;
+
+- (const int32_t *)operandSymbolsForOperand:(int)operandIndex;
+
+- (int)symbolForName:(NSString *)name;
+
+- (NSString *)nameForSymbol:(int)symbol;
+
+@end
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "StatmentTable.h"
+
+#define INITIAL_ROW_CAPACITY 64
+#define INITIAL_DAT_CAPACITY 256
+
+@interface StatmentTable ()
+{
+	NSUInteger rowCapacity;
+	NSUInteger datCount;
+	NSUInteger datCapacity;
+
+	uint8_t *opcodeColumn;
+	uint8_t *opcodeNonBasicColumn;
+	int32_t *labelColumn;
+	int32_t *lineNumberColumn;
+	uint32_t *datOffsetColumn;
+	uint32_t *datLengthColumn;
+	int32_t *includeColumn;
+	uint16_t *operandKindColumn[2];
+	uint8_t *operandRegisterColumn[2];
+	uint16_t *operandNextWordColumn[2];
+	int32_t *operandSymbolColumn[2];
+	uint16_t *dat;
+}
+
+@property(nonatomic, readwrite) NSUInteger count;
+@property(nonatomic, strong, readwrite) SymbolTable *symbols;
+@property(nonatomic, strong) NSMutableArray *binaryIncludes;
+
+@end
+
+@implementation StatmentTable
+
+@synthesize count;
+@synthesize symbols;
+@synthesize binaryIncludes;
+
++ (StatmentTable *)tableWithStatments:(NSArray *)statments
+{
+	StatmentTable *table = [[StatmentTable alloc] init];
+
+	for(Statment *statment in statments)
+	{
+		[table addStatment:statment];
+	}
+
+	return table;
+}
+
+- (id)init
+{
+	return [self initWithSymbolTable:[[SymbolTable alloc] init]];
+}
+
+- (id)initWithSymbolTable:(SymbolTable *)symbolTable
+{
+	self = [super init];
+
+	self.symbols = symbolTable;
+	self.binaryIncludes = [[NSMutableArray alloc] init];
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(opcodeColumn);
+	free(opcodeNonBasicColumn);
+	free(labelColumn);
+	free(lineNumberColumn);
+	free(datOffsetColumn);
+	free(datLengthColumn);
+	free(includeColumn);
+
+	for(int i = 0; i < 2; i++)
+	{
+		free(operandKindColumn[i]);
+		free(operandRegisterColumn[i]);
+		free(operandNextWordColumn[i]);
+		free(operandSymbolColumn[i]);
+	}
+
+	free(dat);
+}
+
+- (void)ensureRowCapacity
+{
+	if(count < rowCapacity)
+	{
+		return;
+	}
+
+	rowCapacity = rowCapacity == 0 ? INITIAL_ROW_CAPACITY : rowCapacity * 2;
+
+	opcodeColumn = realloc(opcodeColumn, rowCapacity * sizeof(uint8_t));
+	opcodeNonBasicColumn = realloc(opcodeNonBasicColumn, rowCapacity * sizeof(uint8_t));
+	labelColumn = realloc(labelColumn, rowCapacity * sizeof(int32_t));
+	lineNumberColumn = realloc(lineNumberColumn, rowCapacity * sizeof(int32_t));
+	datOffsetColumn = realloc(datOffsetColumn, rowCapacity * sizeof(uint32_t));
+	datLengthColumn = realloc(datLengthColumn, rowCapacity * sizeof(uint32_t));
+	includeColumn = realloc(includeColumn, rowCapacity * sizeof(int32_t));
+
+	for(int i = 0; i < 2; i++)
+	{
+		operandKindColumn[i] = realloc(operandKindColumn[i], rowCapacity * sizeof(uint16_t));
+		operandRegisterColumn[i] = realloc(operandRegisterColumn[i], rowCapacity * sizeof(uint8_t));
+		operandNextWordColumn[i] = realloc(operandNextWordColumn[i], rowCapacity * sizeof(uint16_t));
+		operandSymbolColumn[i] = realloc(operandSymbolColumn[i], rowCapacity * sizeof(int32_t));
+	}
+}
+
+- (void)appendDatWords:(const uint16_t *)words count:(NSUInteger)wordCount
+{
+	if(datCount + wordCount > datCapacity)
+	{
+		datCapacity = datCapacity == 0 ? INITIAL_DAT_CAPACITY : datCapacity;
+
+		while(datCount + wordCount > datCapacity)
+		{
+			datCapacity *= 2;
+		}
+
+		dat = realloc(dat, datCapacity * sizeof(uint16_t));
+	}
+
+	memcpy(dat + datCount, words, wordCount * sizeof(uint16_t));
+	datCount += wordCount;
+}
+
+- (void)addStatment:(Statment *)statment
+{
+	[self ensureRowCapacity];
+
+	NSUInteger row = count;
+
+	opcodeColumn[row] = (uint8_t) statment.opcode;
+	opcodeNonBasicColumn[row] = (uint8_t) statment.opcodeNonBasic;
+	lineNumberColumn[row] = statment.lineNumber;
+	labelColumn[row] = NO_SYMBOL;
+
+	if([statment.label length] > 0)
+	{
+		labelColumn[row] = [self.symbols symbolForName:statment.label fromIndex:1];
+		[self.symbols defineSymbol:labelColumn[row] atLine:statment.lineNumber];
+	}
+
+	[self setOperand:statment.firstOperand atIndex:FIRST_OPERAND forRow:row];
+	[self setOperand:statment.secondOperand atIndex:SECOND_OPERAND forRow:row];
+
+	datOffsetColumn[row] = (uint32_t) datCount;
+
+	[self appendDatWords:[statment.dat bytes] count:[statment.dat length] / sizeof(uint16_t)];
+	datLengthColumn[row] = (uint32_t) (datCount - datOffsetColumn[row]);
+
+	includeColumn[row] = NO_INCLUDE;
+
+	if(statment.binaryInclude != nil)
+	{
+		includeColumn[row] = (int32_t) [self.binaryIncludes count];
+		[self.binaryIncludes addObject:statment.binaryInclude];
+	}
+
+	self.count = row + 1;
+}
+
+- (void)setOperand:(Operand *)operand atIndex:(int)index forRow:(NSUInteger)row
+{
+	operandKindColumn[index][row] = (uint16_t) (operand != nil ? [operand operandType] : O_NULL);
+	operandRegisterColumn[index][row] = (uint8_t) operand.registerValue;
+	operandNextWordColumn[index][row] = operand.nextWord;
+	operandSymbolColumn[index][row] = [operand.label length] > 0 ? [self.symbols symbolForName:operand.label] : NO_SYMBOL;
+}
+
+- (int)symbolForName:(NSString *)name
+{
+	return [self.symbols symbolForName:name];
+}
+
+- (NSString *)nameForSymbol:(int)symbol
+{
+	return [self.symbols nameForSymbol:symbol];
+}
+
+- (NSUInteger)symbolCount
+{
+	return self.symbols.count;
+}
+
+- (const uint8_t *)opcodes
+{
+	return opcodeColumn;
+}
+
+- (const uint8_t *)opcodesNonBasic
+{
+	return opcodeNonBasicColumn;
+}
+
+- (const int32_t *)labels
+{
+	return labelColumn;
+}
+
+- (const int32_t *)lineNumbers
+{
+	return lineNumberColumn;
+}
+
+- (const uint32_t *)datOffsets
+{
+	return datOffsetColumn;
+}
+
+- (const uint32_t *)datLengths
+{
+	return datLengthColumn;
+}
+
+- (const uint16_t *)datArena
+{
+	return dat;
+}
+
+- (NSData *)binaryIncludeForRow:(NSUInteger)row
+{
+	if(includeColumn[row] == NO_INCLUDE)
+	{
+		return nil;
+	}
+
+	return [self.binaryIncludes objectAtIndex:(NSUInteger) includeColumn[row]];
+}
+
+- (const uint16_t *)operandKindsForOperand:(int)operandIndex
+{
+	return operandKindColumn[operandIndex];
+}
+
+- (const uint8_t *)operandRegistersForOperand:(int)operandIndex
+{
+	return operandRegisterColumn[operandIndex];
+}
+
+- (const uint16_t *)operandNextWordsForOperand:(int)operandIndex
+{
+	return operandNextWordColumn[operandIndex];
+}
+
+- (const int32_t *)operandSymbolsForOperand:(int)operandIndex
+{
+	return operandSymbolColumn[operandIndex];
+}
+
+@end
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#define NO_SYMBOL -1
+#define UNDEFINED_LINE 0
+
+// Interns label names once into a byte arena and hands out dense ids, so the rest of
+// the pipeline refers to labels by index into flat arrays. Each symbol also keeps the
+// source line of its definition for diagnostics and symbolization.
+@interface SymbolTable : NSObject
+
+@property(nonatomic, readonly) NSUInteger count;
+
+- (int)symbolForName:(NSString *)name;
+
+// Interns name from index on, e.g. 1 to drop the ':' of a label definition.
+- (int)symbolForName:(NSString *)name fromIndex:(NSUInteger)index;
+
+- (int)symbolForBytes:(const char *)bytes length:(NSUInteger)length;
+
+- (int)lookupName:(NSString *)name;
+
+- (NSString *)nameForSymbol:(int)symbol;
+
+- (void)defineSymbol:(int)symbol atLine:(int)line;
+
+- (int)definitionLineForSymbol:(int)symbol;
+
+@end
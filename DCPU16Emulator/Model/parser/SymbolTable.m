@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "SymbolTable.h"
+
+#define INITIAL_SYMBOL_CAPACITY 64
+#define INITIAL_ARENA_CAPACITY 1024
+#define NAME_BUFFER_LENGTH 128
+#define EMPTY_SLOT -1
+
+@implementation SymbolTable
+{
+	char *arena;
+	NSUInteger arenaLength;
+	NSUInteger arenaCapacity;
+
+	uint32_t *nameOffsets;
+	uint32_t *nameLengths;
+	uint32_t *nameHashes;
+	int32_t *definitionLines;
+	NSUInteger symbolCapacity;
+
+	int32_t *slots;
+	NSUInteger slotCount;
+}
+
+@synthesize count;
+
+- (void)dealloc
+{
+	free(arena);
+	free(nameOffsets);
+	free(nameLengths);
+	free(nameHashes);
+	free(definitionLines);
+	free(slots);
+}
+
+static uint32_t hashBytes(const char *bytes, NSUInteger length)
+{
+	uint32_t hash = 2166136261u;
+
+	for(NSUInteger i = 0; i < length; i++)
+	{
+		hash ^= (uint8_t) bytes[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+- (int)symbolForName:(NSString *)name
+{
+	return [self symbolForName:name fromIndex:0];
+}
+
+- (int)symbolForName:(NSString *)name fromIndex:(NSUInteger)index
+{
+	return [self symbolForName:name fromIndex:index insert:YES];
+}
+
+- (int)lookupName:(NSString *)name
+{
+	return [self symbolForName:name fromIndex:0 insert:NO];
+}
+
+- (int)symbolForName:(NSString *)name fromIndex:(NSUInteger)index insert:(BOOL)insert
+{
+	char buffer[NAME_BUFFER_LENGTH];
+	NSUInteger length = 0;
+	NSRange remaining;
+	NSRange range = NSMakeRange(index, [name length] - index);
+
+	[name getBytes:buffer maxLength:NAME_BUFFER_LENGTH usedLength:&length encoding:NSUTF8StringEncoding
+		   options:0 range:range remainingRange:&remaining];
+
+	if(remaining.length > 0)
+	{
+		const char *utf8 = [[name substringWithRange:range] UTF8String];
+		return [self symbolForBytes:utf8 length:strlen(utf8) insert:insert];
+	}
+
+	return [self symbolForBytes:buffer length:length insert:insert];
+}
+
+- (int)symbolForBytes:(const char *)bytes length:(NSUInteger)length
+{
+	return [self symbolForBytes:bytes length:length insert:YES];
+}
+
+- (int)symbolForBytes:(const char *)bytes length:(NSUInteger)length insert:(BOOL)insert
+{
+	uint32_t hash = hashBytes(bytes, length);
+
+	if(slotCount > 0)
+	{
+		NSUInteger mask = slotCount - 1;
+
+		for(NSUInteger slot = hash & mask; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+		{
+			int32_t symbol = slots[slot];
+
+			if(nameHashes[symbol] == hash && nameLengths[symbol] == length
+					&& memcmp(arena + nameOffsets[symbol], bytes, length) == 0)
+			{
+				return symbol;
+			}
+		}
+	}
+
+	if(!insert)
+	{
+		return NO_SYMBOL;
+	}
+
+	return [self addSymbolWithBytes:bytes length:length hash:hash];
+}
+
+- (int)addSymbolWithBytes:(const char *)bytes length:(NSUInteger)length hash:(uint32_t)hash
+{
+	if(count == symbolCapacity)
+	{
+		symbolCapacity = symbolCapacity == 0 ? INITIAL_SYMBOL_CAPACITY : symbolCapacity * 2;
+		nameOffsets = realloc(nameOffsets, symbolCapacity * sizeof(uint32_t));
+		nameLengths = realloc(nameLengths, symbolCapacity * sizeof(uint32_t));
+		nameHashes = realloc(nameHashes, symbolCapacity * sizeof(uint32_t));
+		definitionLines = realloc(definitionLines, symbolCapacity * sizeof(int32_t));
+	}
+
+	if(arenaLength + length > arenaCapacity)
+	{
+		arenaCapacity = arenaCapacity == 0 ? INITIAL_ARENA_CAPACITY : arenaCapacity;
+
+		while(arenaLength + length > arenaCapacity)
+		{
+			arenaCapacity *= 2;
+		}
+
+		arena = realloc(arena, arenaCapacity);
+	}
+
+	int symbol = (int) count;
+
+	memcpy(arena + arenaLength, bytes, length);
+	nameOffsets[symbol] = (uint32_t) arenaLength;
+	nameLengths[symbol] = (uint32_t) length;
+	nameHashes[symbol] = hash;
+	definitionLines[symbol] = UNDEFINED_LINE;
+	arenaLength += length;
+	count++;
+
+	if(count * 2 > slotCount)
+	{
+		[self growSlots];
+	}
+	else
+	{
+		[self insertSymbolIntoSlots:symbol];
+	}
+
+	return symbol;
+}
+
+- (void)growSlots
+{
+	free(slots);
+
+	slotCount = slotCount == 0 ? INITIAL_SYMBOL_CAPACITY * 2 : slotCount * 2;
+	slots = malloc(slotCount * sizeof(int32_t));
+	memset(slots, 0xFF, slotCount * sizeof(int32_t));
+
+	for(NSUInteger symbol = 0; symbol < count; symbol++)
+	{
+		[self insertSymbolIntoSlots:(int) symbol];
+	}
+}
+
+- (void)insertSymbolIntoSlots:(int)symbol
+{
+	NSUInteger mask = slotCount - 1;
+	NSUInteger slot = nameHashes[symbol] & mask;
+
+	while(slots[slot] != EMPTY_SLOT)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	slots[slot] = symbol;
+}
+
+- (NSString *)nameForSymbol:(int)symbol
+{
+	return [[NSString alloc] initWithBytes:arena + nameOffsets[symbol] length:nameLengths[symbol] encoding:NSUTF8StringEncoding];
+}
+
+- (void)defineSymbol:(int)symbol atLine:(int)line
+{
+	definitionLines[symbol] = line;
+}
+
+- (int)definitionLineForSymbol:(int)symbol
+{
+	return definitionLines[symbol];
+}
+
+@end
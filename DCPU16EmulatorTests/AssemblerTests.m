@@ -27,6 +27,21 @@
 #import "Lexer.h"
 #import "IgnoreWhiteSpaceTokenStrategy.h"
 #import "ConsumeToken.h"
+#import "StatmentTable.h"
+
+// Fails every row the way a Foundation call inside the encoder would.
+@interface RaisingAssembler : Assembler
+
+@end
+
+@implementation RaisingAssembler
+
+- (void)assembleStatmentAtRow:(NSUInteger)row
+{
+	[NSException raise:NSRangeException format:@"row %u", (unsigned) row];
+}
+
+@end
 
 @implementation AssemblerTests
 
@@ -213,4 +228,186 @@
 	}
 }
 
+- (void)testAssembleStatmentTableGeneratesSameProgramAsStatments
+{
+	NSString *code = @"\n\
+            SET I, 10               ; a861\n\
+            SET A, 0x2000           ; 7c01 2000\n\
+:loop       SET [0x2000+I], [A]     ; 2161 2000\n\
+            SUB I, 1                ; 8463\n\
+            IFN I, 0                ; 806d\n\
+            SET PC, loop            ; 7dc1 0003 [*]\n\
+            JSR loop                ; 7c10 0003 [*]";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:p.statments];
+
+	lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+								  consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	StatmentTable *table = [[StatmentTable alloc] init];
+	[p parseSource:code withLexer:lexer intoTable:table];
+
+	Assembler *tableAssembler = [[Assembler alloc] init];
+	[tableAssembler assembleStatmentTable:table];
+
+	STAssertEquals((int)table.count, 7, nil);
+	STAssertEquals((int)table.symbolCount, 1, nil);
+	STAssertEquals((int)[p.statments count], 0, nil);
+	STAssertEqualObjects(tableAssembler.program, assembler.program, nil);
+	STAssertEquals((int)[tableAssembler.program count], 11, nil);
+	STAssertEquals([[tableAssembler.program objectAtIndex:8] intValue], 0x0003, nil);
+	STAssertEquals([[tableAssembler.program objectAtIndex:10] intValue], 0x0003, nil);
+}
+
+- (void)testAssembleStatmentsCalledWithBinaryIncludeSplicesBigEndianWords
+{
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"incbin.bin"];
+	const uint8_t bytes[] = {0x12, 0x34, 0xAB, 0xCD};
+	[[NSData dataWithBytes:bytes length:sizeof(bytes)] writeToFile:path atomically:YES];
+
+	NSString *code = @"SET A, 1\n\
+	.incbin \"incbin.bin\"";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	p.includeDirectory = NSTemporaryDirectory();
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:p.statments];
+
+	STAssertEquals((int)[assembler.program count], 3, nil);
+	STAssertEquals([[assembler.program objectAtIndex:1] intValue], 0x1234, nil);
+	STAssertEquals([[assembler.program objectAtIndex:2] intValue], 0xABCD, nil);
+}
+
+- (void)testAssembleStatmentsExposesWordsAndImageMatchingProgram
+{
+	NSString *code = @":loop SET A, 0x2000\n\
+	SET PC, loop\n\
+	SET PC, end\n\
+	:end SET B, 1";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:p.statments];
+
+	STAssertEquals((int)assembler.wordCount, 7, nil);
+	STAssertEquals(assembler.words[3], (uint16_t)0x0000, nil);
+	STAssertEquals(assembler.words[5], (uint16_t)0x0006, nil);
+	STAssertEquals((int)[[assembler image] length], 14, nil);
+
+	for(NSUInteger i = 0; i < assembler.wordCount; i++)
+	{
+		STAssertEquals([[assembler.program objectAtIndex:i] intValue], (int)assembler.words[i], nil);
+	}
+}
+
+- (void)testAssembleStatmentsWithRelaxationShrinksLabelsUntilFixedPoint
+{
+	NSMutableString *code = [NSMutableString stringWithString:@":start SET PC, start\nSET PC, end\nDAT 0"];
+
+	for(int i = 1; i < 28; i++)
+	{
+		[code appendString:@", 0"];
+	}
+
+	[code appendString:@"\n:end SET B, 1"];
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:p.statments];
+
+	STAssertEquals((int)assembler.wordCount, 33, nil);
+	STAssertEquals((int)assembler.relaxedReferenceCount, 0, nil);
+
+	assembler.relaxLabelReferences = YES;
+	[assembler assembleStatments:p.statments];
+
+	STAssertEquals((int)assembler.wordCount, 31, nil);
+	STAssertEquals((int)assembler.relaxedReferenceCount, 2, nil);
+	STAssertEquals(assembler.words[0], (uint16_t)0x81C1, nil);
+	STAssertEquals(assembler.words[1], (uint16_t)0xF9C1, nil);
+	STAssertEquals(assembler.words[30], (uint16_t)0x8411, nil);
+}
+
+- (void)testAssembleStatmentsWithSmallChunksGeneratesSameWordsAndFixupsAsSingleChunk
+{
+	NSMutableString *code = [NSMutableString string];
+
+	for(int i = 0; i < 200; i++)
+	{
+		[code appendFormat:@"%@:l%d SET A, 0x%X\nIFN A, %d\nSET PC, l%d\nDAT 1, 2, 3\nJSR l%d", i == 0 ? @"" : @"\n", i, 0x100 + i, i % 40, (i * 7) % 200, (i + 1) % 200];
+	}
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *serial = [[Assembler alloc] init];
+	[serial assembleStatments:p.statments];
+
+	Assembler *chunked = [[Assembler alloc] init];
+	chunked.rowsPerChunk = 3;
+	[chunked assembleStatments:p.statments];
+
+	STAssertEqualObjects([chunked image], [serial image], nil);
+	STAssertEquals(chunked.fixupCount, serial.fixupCount, nil);
+	STAssertEquals(chunked.fixupCount, (NSUInteger)400, nil);
+
+	for(NSUInteger i = 0; i < serial.fixupCount; i++)
+	{
+		STAssertEquals(chunked.fixups[i].offset, serial.fixups[i].offset, nil);
+		STAssertEquals(chunked.fixups[i].symbol, serial.fixups[i].symbol, nil);
+	}
+
+	STAssertEquals(chunked.rowOffsets[5], (uint32_t)10, nil);
+}
+
+- (void)testAssembleStatmentsCalledWhenEncoderRaisesThrowsMessageOfFirstChunk
+{
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+																 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:@"SET A, 1\nSET B, 2\nSET C, 3\nSET X, 4" withLexer:lexer];
+
+	Assembler *assembler = [[RaisingAssembler alloc] init];
+	assembler.rowsPerChunk = 1;
+
+	NSString *failure = nil;
+
+	@try
+	{
+		[assembler assembleStatments:p.statments];
+	}
+	@catch(NSString *message)
+	{
+		failure = message;
+	}
+
+	STAssertEqualObjects(failure, @"NSRangeException: row 0", nil);
+}
+
 @end
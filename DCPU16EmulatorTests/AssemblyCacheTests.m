@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "AssemblyCacheTests.h"
+#import "AssemblyCache.h"
+#import "AssemblyMemoryCache.h"
+#import "CachedAssembly.h"
+#import "AssemblyTestSupport.h"
+
+@implementation AssemblyCacheTests
+
+- (NSString *)sampleSource
+{
+	return @"SET PC, start\nSET A, 0x30\n:start SET I, 10\n:loop SUB I, 1\nIFN I, 0\nSET PC, loop\n:end SET B, 1";
+}
+
+- (NSString *)temporaryDirectory
+{
+	NSString *name = [NSString stringWithFormat:@"AssemblyCacheTests-%@", [[NSProcessInfo processInfo] globallyUniqueString]];
+	return [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+}
+
+- (void)testAssembleSourceCalledTwiceReturnsCachedEntryWithoutAssembling
+{
+	AssemblyCache *cache = [[AssemblyCache alloc] init];
+
+	CachedAssembly *first = [cache assembleSource:[self sampleSource]];
+	CachedAssembly *second = [cache assembleSource:[self sampleSource]];
+
+	STAssertTrue(first == second, nil);
+	STAssertEquals(cache.missCount, (NSUInteger)1, nil);
+	STAssertEquals(cache.memoryHitCount, (NSUInteger)1, nil);
+	STAssertEqualObjects(second.image, [AssemblyTestSupport imageOfSource:[self sampleSource]], nil);
+	STAssertEquals([second addressOfLabel:@"loop"], 5, nil);
+}
+
+- (void)testKeyForSourceDependsOnAssemblerOptions
+{
+	AssemblyCache *cache = [[AssemblyCache alloc] init];
+	NSString *key = [cache keyForSource:[self sampleSource]];
+
+	STAssertEqualObjects([cache keyForSource:[self sampleSource]], key, nil);
+	STAssertFalse([[cache keyForSource:@"SET A, 1"] isEqualToString:key], nil);
+
+	cache.relaxLabelReferences = YES;
+
+	STAssertFalse([[cache keyForSource:[self sampleSource]] isEqualToString:key], nil);
+}
+
+- (void)testAssembleSourceCalledWithDirectoryReadsEntryWrittenByAnotherCache
+{
+	NSString *directory = [self temporaryDirectory];
+
+	AssemblyCache *writer = [[AssemblyCache alloc] initWithDirectory:directory];
+	CachedAssembly *written = [writer assembleSource:[self sampleSource]];
+
+	AssemblyCache *reader = [[AssemblyCache alloc] initWithDirectory:directory];
+	CachedAssembly *read = [reader assembleSource:[self sampleSource]];
+
+	STAssertEquals(reader.diskHitCount, (NSUInteger)1, nil);
+	STAssertEquals(reader.missCount, (NSUInteger)0, nil);
+	STAssertEqualObjects(read.image, written.image, nil);
+	STAssertEquals(read.symbols.count, written.symbols.count, nil);
+	STAssertEquals([read addressOfLabel:@"start"], [written addressOfLabel:@"start"], nil);
+	STAssertEquals([read addressOfLabel:@"end"], [written addressOfLabel:@"end"], nil);
+
+	[reader removeAllObjects];
+	[[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+}
+
+- (void)testRemoveAllObjectsKeepsFilesTheCacheDidNotWrite
+{
+	NSString *directory = [self temporaryDirectory];
+	NSString *foreign = [directory stringByAppendingPathComponent:@"notes.txt"];
+
+	AssemblyCache *cache = [[AssemblyCache alloc] initWithDirectory:directory];
+	[cache assembleSource:[self sampleSource]];
+	[@"keep" writeToFile:foreign atomically:YES encoding:NSUTF8StringEncoding error:nil];
+
+	[cache removeAllObjects];
+
+	NSArray *remaining = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directory error:nil];
+
+	STAssertEqualObjects(remaining, @[@"notes.txt"], nil);
+
+	[[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+}
+
+- (void)testIsCacheableSourceLooksAtDirectivesOnly
+{
+	AssemblyCache *cache = [[AssemblyCache alloc] init];
+
+	STAssertTrue([cache isCacheableSource:@"SET A, 1 ; no .incbin here"], nil);
+	STAssertTrue([cache isCacheableSource:@"DAT \".incbin\""], nil);
+	STAssertFalse([cache isCacheableSource:@".incbin \"data.bin\""], nil);
+}
+
+- (void)testMemoryCacheEvictsLeastRecentlyUsedEntryOverByteBudget
+{
+	AssemblyCache *cache = [[AssemblyCache alloc] init];
+	CachedAssembly *entry = [cache assembleSource:@"SET A, 0x30"];
+	cache.memoryCache.maxNumberOfBytes = entry.byteCost + 1;
+
+	[cache assembleSource:@"SET B, 0x30"];
+
+	STAssertEquals([cache.memoryCache count], (NSUInteger)1, nil);
+	STAssertTrue(cache.memoryCache.numberOfBytes <= cache.memoryCache.maxNumberOfBytes, nil);
+	STAssertNil([cache.memoryCache objectWithName:[cache keyForSource:@"SET A, 0x30"]], nil);
+}
+
+@end
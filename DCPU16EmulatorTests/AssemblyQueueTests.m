@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "AssemblyQueueTests.h"
+#import "AssemblyQueue.h"
+#import "AssemblyCache.h"
+#import "CachedAssembly.h"
+
+@implementation AssemblyQueueTests
+
+- (BOOL)runMainLoopUntil:(BOOL (^)(void))condition
+{
+	NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+
+	while(!condition())
+	{
+		if([deadline timeIntervalSinceNow] < 0)
+		{
+			return NO;
+		}
+
+		[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+	}
+
+	return YES;
+}
+
+- (NSString *)source
+{
+	return @"\
+            SET A, 0x30\n\
+:loop       SUB A, 1\n\
+            IFN A, 0\n\
+            SET PC, loop";
+}
+
+- (void)testIdenticalRequestsInFlightShareOneJob
+{
+	AssemblyQueue *queue = [[AssemblyQueue alloc] init];
+	__block CachedAssembly *first = nil;
+	__block CachedAssembly *second = nil;
+
+	[queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		first = assembly;
+	}];
+	[queue assembleSource:[self source] priority:NSOperationQueuePriorityHigh completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		second = assembly;
+	}];
+
+	STAssertTrue([self runMainLoopUntil:^BOOL { return first != nil && second != nil; }], nil);
+	STAssertTrue(first == second, nil);
+	STAssertEquals([first addressOfLabel:@"loop"], 2, nil);
+	STAssertEquals(queue.startedJobCount, (NSUInteger) 1, nil);
+	STAssertEquals(queue.joinedRequestCount, (NSUInteger) 1, nil);
+}
+
+- (void)testFinishedResultIsServedFromCacheWithoutAnotherJob
+{
+	AssemblyQueue *queue = [[AssemblyQueue alloc] init];
+	__block int completions = 0;
+
+	[queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		completions++;
+	}];
+
+	STAssertTrue([self runMainLoopUntil:^BOOL { return completions == 1; }], nil);
+
+	[queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		completions++;
+	}];
+
+	STAssertTrue([self runMainLoopUntil:^BOOL { return completions == 2; }], nil);
+	STAssertEquals(queue.startedJobCount, (NSUInteger) 1, nil);
+}
+
+- (void)testCancellingOneRequestStillCompletesTheOthers
+{
+	AssemblyQueue *queue = [[AssemblyQueue alloc] init];
+	__block BOOL cancelledCalled = NO;
+	__block CachedAssembly *kept = nil;
+
+	AssemblyRequest *cancelled = [queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		cancelledCalled = YES;
+	}];
+	[queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		kept = assembly;
+	}];
+
+	[cancelled cancel];
+
+	STAssertTrue([self runMainLoopUntil:^BOOL { return kept != nil; }], nil);
+	STAssertFalse(cancelledCalled, nil);
+}
+
+- (void)testCancellingEveryRequestDeliversNothing
+{
+	AssemblyQueue *queue = [[AssemblyQueue alloc] init];
+	__block BOOL called = NO;
+
+	AssemblyRequest *request = [queue assembleSource:[self source] priority:NSOperationQueuePriorityNormal completion:^(CachedAssembly *assembly, NSString *error)
+	{
+		called = YES;
+	}];
+
+	[request cancel];
+	[queue.operationQueue waitUntilAllOperationsAreFinished];
+	[self runMainLoopUntil:^BOOL { return called; }];
+
+	STAssertFalse(called, nil);
+	STAssertTrue(request.isCancelled, nil);
+}
+
+- (void)testFailedJobDeliversTheErrorToEveryRequest
+{
+	AssemblyQueue *queue = [[AssemblyQueue alloc] init];
+	__block int failures = 0;
+
+	assemblyCompletion completion = ^(CachedAssembly *assembly, NSString *error)
+	{
+		if(assembly == nil && error != nil)
+		{
+			failures++;
+		}
+	};
+
+	[queue assembleSource:@"SET A, ," priority:NSOperationQueuePriorityNormal completion:completion];
+	[queue assembleSource:@"SET A, ," priority:NSOperationQueuePriorityNormal completion:completion];
+
+	STAssertTrue([self runMainLoopUntil:^BOOL { return failures == 2; }], nil);
+	STAssertEquals(queue.startedJobCount, (NSUInteger) 1, nil);
+}
+
+@end
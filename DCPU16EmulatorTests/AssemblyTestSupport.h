@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class Lexer;
+@class Assembler;
+@class StatmentTable;
+
+// Source to statments, table or image the way the editor assembles it, for tests and
+// benchmarks that need a program rather than exercise the pipeline.
+@interface AssemblyTestSupport : NSObject
+
+// A lexer that skips whitespace and consumes every token.
++ (Lexer *)lexer;
+
++ (NSArray *)statmentsOfSource:(NSString *)source;
+
++ (StatmentTable *)tableOfSource:(NSString *)source;
+
++ (Assembler *)assemblerOfTable:(StatmentTable *)table;
+
++ (NSData *)imageOfSource:(NSString *)source;
+
+@end
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblyTestSupport.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "StatmentTable.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+
+@implementation AssemblyTestSupport
+
++ (Lexer *)lexer
+{
+	return [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+								 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+}
+
++ (NSArray *)statmentsOfSource:(NSString *)source
+{
+	Parser *p = [[Parser alloc] init];
+	[p parseSource:source withLexer:[self lexer]];
+
+	return p.statments;
+}
+
++ (StatmentTable *)tableOfSource:(NSString *)source
+{
+	StatmentTable *table = [[StatmentTable alloc] init];
+
+	Parser *p = [[Parser alloc] init];
+	[p parseSource:source withLexer:[self lexer] intoTable:table];
+
+	return table;
+}
+
++ (Assembler *)assemblerOfTable:(StatmentTable *)table
+{
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatmentTable:table];
+
+	return assembler;
+}
+
++ (NSData *)imageOfSource:(NSString *)source
+{
+	return [[self assemblerOfTable:[self tableOfSource:source]] image];
+}
+
+@end
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "BackgroundEmulatorTests.h"
+#import "BackgroundEmulator.h"
+#import "AssemblyTestSupport.h"
+
+@implementation BackgroundEmulatorTests
+
+- (BackgroundEmulator *)emulatorForSource:(NSString *)source
+{
+	return [[BackgroundEmulator alloc] initWithCPU:[[DCPU alloc] initWithImage:[AssemblyTestSupport imageOfSource:source]]];
+}
+
+- (BOOL)waitForState:(struct emulator_state *)state ofEmulator:(BackgroundEmulator *)emulator until:(BOOL (^)(struct emulator_state *))condition
+{
+	for(int attempt = 0; attempt < 2000; attempt++)
+	{
+		[emulator readState:state];
+
+		if(condition(state))
+		{
+			return YES;
+		}
+
+		usleep(1000);
+	}
+
+	return NO;
+}
+
+- (NSString *)loopSource
+{
+	return @"\
+            SET A, 0x30\n\
+            SET [0x1000], 0x20\n\
+            SET B, 5\n\
+:loop       ADD C, 1\n\
+            SET PC, loop";
+}
+
+- (void)testStepExecutesRequestedInstructionsAndPublishesState
+{
+	BackgroundEmulator *emulator = [self emulatorForSource:[self loopSource]];
+	struct emulator_state state;
+
+	STAssertTrue([emulator step:2], nil);
+	STAssertTrue([self waitForState:&state ofEmulator:emulator until:^BOOL(struct emulator_state *s)
+	{
+		return s->instructionCount == 2 && !s->running;
+	}], nil);
+
+	STAssertEquals(state.registers[0], (uint16_t) 0x30, nil);
+	STAssertEquals(state.registers[1], (uint16_t) 0, nil);
+
+	[emulator stop];
+}
+
+- (void)testReadPagesChangedSinceCopiesOnlyWrittenPages
+{
+	BackgroundEmulator *emulator = [self emulatorForSource:[self loopSource]];
+	uint16_t *memory = calloc(MEMORY_SIZE, sizeof(uint16_t));
+	struct emulator_state state;
+
+	uint32_t sequence = [emulator readPagesChangedSince:0 intoMemory:memory];
+
+	STAssertEquals(memory[0], (uint16_t) 0x7c01, nil);
+	STAssertEquals(memory[0x1000], (uint16_t) 0, nil);
+
+	memory[0] = 0;
+
+	[emulator step:2];
+	[self waitForState:&state ofEmulator:emulator until:^BOOL(struct emulator_state *s)
+	{
+		return s->instructionCount == 2 && !s->running;
+	}];
+
+	uint32_t newSequence = [emulator readPagesChangedSince:sequence intoMemory:memory];
+
+	STAssertTrue(newSequence > sequence, nil);
+	STAssertEquals(memory[0x1000], (uint16_t) 0x20, nil);
+	STAssertEquals(memory[0], (uint16_t) 0, nil);
+
+	free(memory);
+	[emulator stop];
+}
+
+- (void)testRunKeepsExecutingUntilPaused
+{
+	BackgroundEmulator *emulator = [self emulatorForSource:[self loopSource]];
+	struct emulator_state state;
+
+	[emulator run];
+
+	STAssertTrue([self waitForState:&state ofEmulator:emulator until:^BOOL(struct emulator_state *s)
+	{
+		return s->instructionCount > 2 * EMULATOR_BATCH_SIZE;
+	}], nil);
+
+	[emulator pause];
+
+	STAssertTrue([self waitForState:&state ofEmulator:emulator until:^BOOL(struct emulator_state *s)
+	{
+		return !s->running;
+	}], nil);
+
+	uint64_t paused = state.instructionCount;
+	usleep(10000);
+	[emulator readState:&state];
+
+	STAssertEquals(state.instructionCount, paused, nil);
+	STAssertFalse(state.halted, nil);
+
+	[emulator stop];
+}
+
+- (void)testEmulatorHaltsOnEmptyInstruction
+{
+	BackgroundEmulator *emulator = [self emulatorForSource:@"SET A, 1"];
+	struct emulator_state state;
+
+	[emulator run];
+
+	STAssertTrue([self waitForState:&state ofEmulator:emulator until:^BOOL(struct emulator_state *s)
+	{
+		return s->halted;
+	}], nil);
+
+	STAssertEquals(state.instructionCount, (uint64_t) 1, nil);
+	STAssertEquals(state.registers[0], (uint16_t) 1, nil);
+
+	[emulator stop];
+}
+
+@end
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class Program;
+
+struct assembler_benchmark_result
+{
+	NSUInteger lines;
+	NSUInteger words;
+
+	// Nanoseconds. Parse time includes the lexing the parser drives.
+	uint64_t lexTime;
+	uint64_t parseTime;
+	uint64_t assembleTime;
+
+	// Program assemble over the instruction lines only, without comments or DAT.
+	NSUInteger programLines;
+	uint64_t programTime;
+
+	uint64_t allocations;
+
+	// Largest growth of the resident set over its size at the start of the run, sampled
+	// after each stage while its data is still alive.
+	uint64_t peakResidentDeltaBytes;
+};
+
+// Times Lexer, Parser, Assembler and Program assemble over generated sources that mix
+// labels, indirect operands, label references, comments and long DAT strings.
+@interface AssemblerBenchmark : NSObject
+
+// 1k, 10k, 100k and 1M lines.
++ (NSArray *)standardLineCounts;
+
+// Same text for the same count on every run.
++ (NSString *)sourceWithLineCount:(NSUInteger)count;
+
+// The instruction lines of sourceWithLineCount: entered through Program's editing calls.
++ (Program *)programWithLineCount:(NSUInteger)count;
+
+- (struct assembler_benchmark_result)runWithLineCount:(NSUInteger)count;
+
+// Allocations are null unless the allocation counter is installed.
+- (NSDictionary *)reportOfResult:(struct assembler_benchmark_result)result;
+
+// Runs each count in order and returns {"benchmark", "runs": [...]}.
+- (NSData *)runLineCountsAsJSON:(NSArray *)counts;
+
+@end
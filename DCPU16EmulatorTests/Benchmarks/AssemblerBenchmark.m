@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblerBenchmark.h"
+#import "BenchmarkSupport.h"
+#import "Program.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "StatmentTable.h"
+#import "Lexer.h"
+#import "AssemblyTestSupport.h"
+
+#define LINE_KINDS 10
+
+typedef void(^generatedLine)(NSString *label, NSString *opcode, NSString *operand1, NSString *operand2, NSString *comment);
+
+static uint64_t sampleResidentDelta(uint64_t peak, uint64_t start)
+{
+	uint64_t now = benchmarkResidentBytes();
+
+	return MAX(peak, now > start ? now - start : 0);
+}
+
+@implementation AssemblerBenchmark
+
++ (NSArray *)standardLineCounts
+{
+	return @[@1000, @10000, @100000, @1000000];
+}
+
+// Every block of LINE_KINDS lines starts with a label the block jumps back to.
++ (void)enumerateLinesOfCount:(NSUInteger)count usingBlock:(generatedLine)line
+{
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		NSUInteger block = i / LINE_KINDS;
+		unsigned word = (unsigned) (i & 0xFFFF);
+
+		switch(i % LINE_KINDS)
+		{
+			case 0:
+				line([NSString stringWithFormat:@":l%u", (unsigned) block], @"SET", @"A", [NSString stringWithFormat:@"0x%X", word], nil);
+				break;
+			case 1:
+				line(nil, @"ADD", @"[0x10+A]", [NSString stringWithFormat:@"%u", word % 30], nil);
+				break;
+			case 2:
+				line(nil, @"SET", [NSString stringWithFormat:@"[0x%X+I]", word], @"B", @"; store B");
+				break;
+			case 3:
+				line(nil, nil, nil, nil, [NSString stringWithFormat:@"; generated block %u", (unsigned) block]);
+				break;
+			case 4:
+				line(nil, @"IFN", @"A", [NSString stringWithFormat:@"0x%X", word], nil);
+				break;
+			case 5:
+				line(nil, @"SET", @"PC", [NSString stringWithFormat:@"l%u", (unsigned) block], nil);
+				break;
+			case 6:
+				line(nil, @"SUB", @"B", @"[0x20+J]", nil);
+				break;
+			case 7:
+				line(nil, @"DAT", @"\"The quick brown fox jumps over the lazy dog 0123\"", nil, nil);
+				break;
+			case 8:
+				line(nil, @"SHL", @"X", @"2", nil);
+				break;
+			default:
+				line(nil, @"SET", [NSString stringWithFormat:@"[0x%X]", word], @"[0x1000+C]", nil);
+				break;
+		}
+	}
+}
+
++ (NSString *)sourceWithLineCount:(NSUInteger)count
+{
+	NSMutableString *source = [NSMutableString stringWithCapacity:count * 24];
+
+	[self enumerateLinesOfCount:count usingBlock:^(NSString *label, NSString *opcode, NSString *operand1, NSString *operand2, NSString *comment)
+	{
+		if(label != nil)
+		{
+			[source appendFormat:@"%@ ", label];
+		}
+
+		if(opcode != nil)
+		{
+			[source appendFormat:operand2 != nil ? @"%@ %@, %@" : @"%@ %@", opcode, operand1, operand2];
+		}
+
+		if(comment != nil)
+		{
+			[source appendFormat:opcode != nil ? @" %@" : @"%@", comment];
+		}
+
+		[source appendString:@"\n"];
+	}];
+
+	return source;
+}
+
++ (Program *)programWithLineCount:(NSUInteger)count
+{
+	Program *program = [[Program alloc] init];
+
+	[self enumerateLinesOfCount:count usingBlock:^(NSString *label, NSString *opcode, NSString *operand1, NSString *operand2, NSString *comment)
+	{
+		if(opcode == nil || [opcode isEqualToString:@"DAT"])
+		{
+			return;
+		}
+
+		if(label != nil)
+		{
+			[program assignLabelToCurrentInstruction:label];
+		}
+
+		[program assignValueToCurrentInstruction:opcode];
+		[program assignValueToCurrentInstruction:operand1];
+		[program assignValueToCurrentInstruction:operand2];
+		[program FinishedInstructionEdit];
+	}];
+
+	[program flushChanges];
+
+	return program;
+}
+
+- (struct assembler_benchmark_result)runWithLineCount:(NSUInteger)count
+{
+	struct assembler_benchmark_result result;
+	memset(&result, 0, sizeof(result));
+
+	result.lines = count;
+
+	NSString *source = [AssemblerBenchmark sourceWithLineCount:count];
+	Program *program = [AssemblerBenchmark programWithLineCount:count];
+	uint64_t allocations = benchmarkAllocationCount();
+	uint64_t resident = benchmarkResidentBytes();
+
+	@autoreleasepool
+	{
+		Lexer *lexer = [AssemblyTestSupport lexer];
+
+		uint64_t start = benchmarkNow();
+
+		[lexer lexSource:source];
+
+		while([lexer nextToken])
+		{
+		}
+
+		result.lexTime = benchmarkNow() - start;
+		result.peakResidentDeltaBytes = sampleResidentDelta(result.peakResidentDeltaBytes, resident);
+	}
+
+	@autoreleasepool
+	{
+		Lexer *lexer = [AssemblyTestSupport lexer];
+
+		StatmentTable *table = [[StatmentTable alloc] init];
+		Parser *parser = [[Parser alloc] init];
+
+		uint64_t start = benchmarkNow();
+		[parser parseSource:source withLexer:lexer intoTable:table];
+		result.parseTime = benchmarkNow() - start;
+		result.peakResidentDeltaBytes = sampleResidentDelta(result.peakResidentDeltaBytes, resident);
+
+		Assembler *assembler = [[Assembler alloc] init];
+
+		start = benchmarkNow();
+		[assembler assembleStatmentTable:table];
+		result.assembleTime = benchmarkNow() - start;
+		result.peakResidentDeltaBytes = sampleResidentDelta(result.peakResidentDeltaBytes, resident);
+
+		result.words = assembler.wordCount;
+	}
+
+	@autoreleasepool
+	{
+		result.programLines = [program.instructionSet count];
+
+		uint64_t start = benchmarkNow();
+		[program assemble];
+		result.programTime = benchmarkNow() - start;
+		result.peakResidentDeltaBytes = sampleResidentDelta(result.peakResidentDeltaBytes, resident);
+	}
+
+	result.allocations = benchmarkAllocationCount() - allocations;
+
+	return result;
+}
+
+- (NSDictionary *)reportOfResult:(struct assembler_benchmark_result)result
+{
+	double lexSeconds = MAX(result.lexTime, 1) / 1e9;
+	double parseSeconds = MAX(result.parseTime, 1) / 1e9;
+	double assembleSeconds = MAX(result.assembleTime, 1) / 1e9;
+	double programSeconds = MAX(result.programTime, 1) / 1e9;
+	BOOL counted = benchmarkAllocationCounterInstalled();
+
+	return @{
+		@"lines": @(result.lines),
+		@"words": @(result.words),
+		@"lex_seconds": @(lexSeconds),
+		@"parse_seconds": @(parseSeconds),
+		@"assemble_seconds": @(assembleSeconds),
+		@"lex_lines_per_second": @(result.lines / lexSeconds),
+		@"parse_lines_per_second": @(result.lines / parseSeconds),
+		@"assemble_lines_per_second": @(result.lines / assembleSeconds),
+		@"program_lines": @(result.programLines),
+		@"program_seconds": @(programSeconds),
+		@"program_lines_per_second": @(result.programLines / programSeconds),
+		@"allocations": counted ? @(result.allocations) : (id) [NSNull null],
+		@"peak_resident_delta_bytes": @(result.peakResidentDeltaBytes)
+	};
+}
+
+- (NSData *)runLineCountsAsJSON:(NSArray *)counts
+{
+	NSMutableArray *runs = [NSMutableArray array];
+
+	for(NSNumber *count in counts)
+	{
+		[runs addObject:[self reportOfResult:[self runWithLineCount:[count unsignedIntegerValue]]]];
+	}
+
+	NSDictionary *report = @{
+		@"benchmark": @"assembler",
+		@"runs": runs
+	};
+
+	return [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:NULL];
+}
+
+@end
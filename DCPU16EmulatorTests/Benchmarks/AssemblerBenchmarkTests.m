@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "AssemblerBenchmarkTests.h"
+#import "AssemblerBenchmark.h"
+#import "BenchmarkSupport.h"
+#import "Program.h"
+
+// Full runs only happen when DCPU16_BENCHMARK is set; DCPU16_ASSEMBLER_BENCHMARK_OUTPUT
+// names a file for the JSON report, otherwise it is logged.
+@implementation AssemblerBenchmarkTests
+
+- (void)testSourceWithLineCountCalledTwiceReturnsTheSameLines
+{
+	NSString *source = [AssemblerBenchmark sourceWithLineCount:1000];
+	NSArray *lines = [source componentsSeparatedByString:@"\n"];
+
+	STAssertEquals([lines count], (NSUInteger)1001, nil);
+	STAssertEqualObjects([lines objectAtIndex:0], @":l0 SET A, 0x0", nil);
+	STAssertEqualObjects([lines objectAtIndex:1], @"ADD [0x10+A], 1", nil);
+	STAssertEqualObjects(source, [AssemblerBenchmark sourceWithLineCount:1000], nil);
+}
+
+- (void)testProgramWithLineCountSkipsCommentsAndData
+{
+	Program *program = [AssemblerBenchmark programWithLineCount:1000];
+
+	STAssertEquals([program.instructionSet count], (NSUInteger)800, nil);
+}
+
+- (void)testRunWithLineCountTimesEveryStage
+{
+	struct assembler_benchmark_result result = [[[AssemblerBenchmark alloc] init] runWithLineCount:1000];
+
+	STAssertEquals(result.lines, (NSUInteger)1000, nil);
+	STAssertEquals(result.programLines, (NSUInteger)800, nil);
+	STAssertTrue(result.words > 0, nil);
+	STAssertTrue(result.lexTime > 0, nil);
+	STAssertTrue(result.parseTime > 0, nil);
+	STAssertTrue(result.assembleTime > 0, nil);
+	STAssertTrue(result.programTime > 0, nil);
+	STAssertTrue(result.peakResidentDeltaBytes < benchmarkResidentBytes(), nil);
+}
+
+- (void)testRunStandardLineCounts
+{
+	NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+
+	if([environment objectForKey:@"DCPU16_BENCHMARK"] == nil)
+	{
+		return;
+	}
+
+	benchmarkInstallAllocationCounter();
+
+	NSData *json = [[[AssemblerBenchmark alloc] init] runLineCountsAsJSON:[AssemblerBenchmark standardLineCounts]];
+	NSString *output = [environment objectForKey:@"DCPU16_ASSEMBLER_BENCHMARK_OUTPUT"];
+
+	if(output != nil)
+	{
+		STAssertTrue([json writeToFile:output atomically:YES], nil);
+	}
+	else
+	{
+		NSLog(@"%@", [[NSString alloc] initWithData:json encoding:NSUTF8StringEncoding]);
+	}
+}
+
+@end
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+// Shared clock and allocation counter for the benchmark suites.
+
+// Monotonic nanoseconds.
+uint64_t benchmarkNow(void);
+
+// Wraps malloc, calloc and realloc of the default malloc zone with a counter, once per
+// process; every realloc counts, since growing a buffer may move it. Allocations made
+// through other zones are not seen. Returns NO if the zone cannot be patched, in which
+// case allocation counts must not be reported.
+BOOL benchmarkInstallAllocationCounter(void);
+
+BOOL benchmarkAllocationCounterInstalled(void);
+
+uint64_t benchmarkAllocationCount(void);
+
+// Current resident set of the process, in bytes, or 0 if it cannot be read.
+uint64_t benchmarkResidentBytes(void);
+
+struct benchmark_summary
+{
+	NSUInteger count;
+	double mean;
+	double standardDeviation;
+
+	// Half width of the 95% confidence interval of the mean, from Student's t.
+	double confidence;
+};
+
+struct benchmark_summary benchmarkSummarize(const double *samples, NSUInteger count);
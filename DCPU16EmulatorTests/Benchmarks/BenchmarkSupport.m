@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "BenchmarkSupport.h"
+#import <libkern/OSAtomic.h>
+#import <malloc/malloc.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <math.h>
+
+static volatile int64_t allocationCount;
+static BOOL allocationCounterInstalled;
+static void *(*systemMalloc)(struct _malloc_zone_t *zone, size_t size);
+static void *(*systemCalloc)(struct _malloc_zone_t *zone, size_t count, size_t size);
+static void *(*systemRealloc)(struct _malloc_zone_t *zone, void *pointer, size_t size);
+
+static void *countingMalloc(struct _malloc_zone_t *zone, size_t size)
+{
+	OSAtomicIncrement64(&allocationCount);
+	return systemMalloc(zone, size);
+}
+
+static void *countingCalloc(struct _malloc_zone_t *zone, size_t count, size_t size)
+{
+	OSAtomicIncrement64(&allocationCount);
+	return systemCalloc(zone, count, size);
+}
+
+static void *countingRealloc(struct _malloc_zone_t *zone, void *pointer, size_t size)
+{
+	OSAtomicIncrement64(&allocationCount);
+	return systemRealloc(zone, pointer, size);
+}
+
+uint64_t benchmarkNow(void)
+{
+	static mach_timebase_info_data_t timebase;
+
+	if(timebase.denom == 0)
+	{
+		mach_timebase_info(&timebase);
+	}
+
+	return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+BOOL benchmarkInstallAllocationCounter(void)
+{
+	static dispatch_once_t once;
+
+	dispatch_once(&once, ^
+	{
+		malloc_zone_t *zone = malloc_default_zone();
+
+		// The zone's function table is read only from malloc zone version 8 on. Without
+		// write access the counter is left uninstalled rather than faulting.
+		if(vm_protect(mach_task_self(), (vm_address_t) zone, sizeof(*zone), 0, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS)
+		{
+			NSLog(@"Allocation counter not installed: default malloc zone is not writable");
+			return;
+		}
+
+		systemMalloc = zone->malloc;
+		systemCalloc = zone->calloc;
+		systemRealloc = zone->realloc;
+		zone->malloc = countingMalloc;
+		zone->calloc = countingCalloc;
+		zone->realloc = countingRealloc;
+
+		if(zone->version >= 8)
+		{
+			vm_protect(mach_task_self(), (vm_address_t) zone, sizeof(*zone), 0, VM_PROT_READ);
+		}
+
+		allocationCounterInstalled = YES;
+	});
+
+	return allocationCounterInstalled;
+}
+
+BOOL benchmarkAllocationCounterInstalled(void)
+{
+	return allocationCounterInstalled;
+}
+
+uint64_t benchmarkAllocationCount(void)
+{
+	return (uint64_t) allocationCount;
+}
+
+uint64_t benchmarkResidentBytes(void)
+{
+	struct mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+	if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+	{
+		return 0;
+	}
+
+	return (uint64_t) info.resident_size;
+}
+
+// Two sided 95% critical values of Student's t for 1 to 30 degrees of freedom.
+static const double studentT95[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+struct benchmark_summary benchmarkSummarize(const double *samples, NSUInteger count)
+{
+	struct benchmark_summary summary;
+	memset(&summary, 0, sizeof(summary));
+
+	summary.count = count;
+
+	if(count == 0)
+	{
+		return summary;
+	}
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		summary.mean += samples[i];
+	}
+
+	summary.mean /= count;
+
+	if(count == 1)
+	{
+		return summary;
+	}
+
+	double squares = 0;
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		squares += (samples[i] - summary.mean) * (samples[i] - summary.mean);
+	}
+
+	NSUInteger degrees = count - 1;
+	double t = degrees <= 30 ? studentT95[degrees - 1] : 1.960;
+
+	summary.standardDeviation = sqrt(squares / degrees);
+	summary.confidence = t * summary.standardDeviation / sqrt((double) count);
+
+	return summary;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+@class DCPU;
+
+#define EMULATOR_BENCHMARK_CYCLES 1000000
+
+struct emulator_benchmark_result
+{
+	uint64_t instructions;
+	uint64_t cycles;
+	uint64_t nanoseconds;
+	uint64_t allocations;
+	BOOL halted;
+};
+
+typedef DCPU *(^emulatorEngineFactory)(NSData *image);
+
+// Runs the standard guest workloads on an engine for a fixed number of spec cycles.
+// Every workload loops forever, so a run only stops early if the engine halts.
+@interface EmulatorBenchmark : NSObject
+
+@property(nonatomic, copy, readonly) NSString *engineName;
+@property(nonatomic, assign) uint64_t cycleBudget;
+
++ (NSArray *)workloadNames;
+
++ (NSString *)sourceOfWorkload:(NSString *)name;
+
+// Benchmarks DCPU.
+- (id)init;
+
+- (id)initWithEngineName:(NSString *)name factory:(emulatorEngineFactory)factory;
+
+// Assembled on first use and kept for every later run.
+- (NSData *)imageOfWorkload:(NSString *)name;
+
+- (struct emulator_benchmark_result)runWorkload:(NSString *)name;
+
+// Allocation fields are null unless the allocation counter is installed.
+- (NSDictionary *)reportOfWorkload:(NSString *)name result:(struct emulator_benchmark_result)result;
+
+// Runs every workload once and returns {"engine", "cycle_budget", "workloads": [...]}.
+- (NSData *)runAllAsJSON;
+
+@end
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "EmulatorBenchmark.h"
+#import "BenchmarkSupport.h"
+#import "DCPU.h"
+#import "CycleCost.h"
+#import "AssemblyTestSupport.h"
+
+@interface EmulatorBenchmark ()
+
+@property(nonatomic, copy, readwrite) NSString *engineName;
+@property(nonatomic, copy) emulatorEngineFactory factory;
+@property(nonatomic, strong) NSMutableDictionary *images;
+
+@end
+
+@implementation EmulatorBenchmark
+
+@synthesize engineName;
+@synthesize cycleBudget;
+@synthesize factory;
+@synthesize images;
+
++ (NSDictionary *)workloads
+{
+	static NSDictionary *workloads;
+	static dispatch_once_t once;
+
+	dispatch_once(&once, ^
+	{
+		workloads = @{
+			@"fibonacci": @"\n\
+				:start SET A, 0\n\
+				SET B, 1\n\
+				SET I, 24\n\
+				:fib SET C, A\n\
+				ADD C, B\n\
+				SET A, B\n\
+				SET B, C\n\
+				SUB I, 1\n\
+				IFN I, 0\n\
+				SET PC, fib\n\
+				SET PC, start",
+
+			@"sieve": @"\n\
+				:start SET I, 0\n\
+				:clear SET [0x4000+I], 0\n\
+				ADD I, 1\n\
+				IFN I, 0x400\n\
+				SET PC, clear\n\
+				SET I, 2\n\
+				:outer IFN [0x4000+I], 0\n\
+				SET PC, next\n\
+				SET J, I\n\
+				ADD J, I\n\
+				:mark IFG J, 0x3FF\n\
+				SET PC, next\n\
+				SET [0x4000+J], 1\n\
+				ADD J, I\n\
+				SET PC, mark\n\
+				:next ADD I, 1\n\
+				IFN I, 0x20\n\
+				SET PC, outer\n\
+				SET PC, start",
+
+			@"memcpy": @"\n\
+				:start SET I, 0\n\
+				:fill SET [0x5000+I], I\n\
+				ADD I, 1\n\
+				IFN I, 0x200\n\
+				SET PC, fill\n\
+				SET I, 0\n\
+				:copy SET [0x6000+I], [0x5000+I]\n\
+				ADD I, 1\n\
+				IFN I, 0x200\n\
+				SET PC, copy\n\
+				SET PC, start",
+
+			@"bubblesort": @"\n\
+				:start SET I, 0\n\
+				:init SET A, 32\n\
+				SUB A, I\n\
+				SET [0x7000+I], A\n\
+				ADD I, 1\n\
+				IFN I, 32\n\
+				SET PC, init\n\
+				SET J, 31\n\
+				:pass SET I, 0\n\
+				:inner SET A, [0x7000+I]\n\
+				SET B, [0x7001+I]\n\
+				IFG A, B\n\
+				SET PC, swap\n\
+				SET PC, nextpair\n\
+				:swap SET [0x7000+I], B\n\
+				SET [0x7001+I], A\n\
+				:nextpair ADD I, 1\n\
+				IFN I, J\n\
+				SET PC, inner\n\
+				SUB J, 1\n\
+				IFN J, 0\n\
+				SET PC, pass\n\
+				SET PC, start",
+
+			@"crc": @"\n\
+				:start SET I, 0\n\
+				SET C, 0xFFFF\n\
+				:word XOR C, [0x5000+I]\n\
+				SET J, 16\n\
+				:bit SET A, C\n\
+				AND A, 1\n\
+				SHR C, 1\n\
+				IFE A, 1\n\
+				XOR C, 0xA001\n\
+				SUB J, 1\n\
+				IFN J, 0\n\
+				SET PC, bit\n\
+				ADD I, 1\n\
+				IFN I, 64\n\
+				SET PC, word\n\
+				SET [0x8000], C\n\
+				SET PC, start",
+
+			@"statemachine": @"\n\
+				:start SET A, 0\n\
+				SET I, 0\n\
+				:step MUL X, 0x6255\n\
+				ADD X, 0x3619\n\
+				SET B, X\n\
+				AND B, 3\n\
+				IFE A, 0\n\
+				SET PC, s0\n\
+				IFE A, 1\n\
+				SET PC, s1\n\
+				IFE A, 2\n\
+				SET PC, s2\n\
+				SET PC, s3\n\
+				:s0 IFG B, 1\n\
+				SET A, 1\n\
+				SET PC, next\n\
+				:s1 IFE B, 0\n\
+				SET A, 2\n\
+				IFE B, 3\n\
+				SET A, 0\n\
+				SET PC, next\n\
+				:s2 IFB B, 1\n\
+				SET A, 3\n\
+				SET PC, next\n\
+				:s3 SET A, B\n\
+				AND A, 1\n\
+				:next ADD I, 1\n\
+				IFN I, 0x100\n\
+				SET PC, step\n\
+				SET PC, start"
+		};
+	});
+
+	return workloads;
+}
+
++ (NSArray *)workloadNames
+{
+	return @[@"fibonacci", @"sieve", @"memcpy", @"bubblesort", @"crc", @"statemachine"];
+}
+
++ (NSString *)sourceOfWorkload:(NSString *)name
+{
+	NSString *source = [[self workloads] objectForKey:name];
+
+	if(source == nil)
+	{
+		@throw [NSString stringWithFormat:@"Unknown workload '%@'", name];
+	}
+
+	return source;
+}
+
+- (id)init
+{
+	return [self initWithEngineName:@"DCPU" factory:^DCPU *(NSData *image)
+	{
+		return [[DCPU alloc] initWithImage:image];
+	}];
+}
+
+- (id)initWithEngineName:(NSString *)name factory:(emulatorEngineFactory)engineFactory
+{
+	self = [super init];
+
+	engineName = [name copy];
+	factory = [engineFactory copy];
+	images = [[NSMutableDictionary alloc] init];
+	cycleBudget = EMULATOR_BENCHMARK_CYCLES;
+
+	return self;
+}
+
+- (NSData *)imageOfWorkload:(NSString *)name
+{
+	NSData *image = [self.images objectForKey:name];
+
+	if(image == nil)
+	{
+		image = [AssemblyTestSupport imageOfSource:[EmulatorBenchmark sourceOfWorkload:name]];
+		[self.images setObject:image forKey:name];
+	}
+
+	return image;
+}
+
+- (struct emulator_benchmark_result)runWorkload:(NSString *)name
+{
+	struct emulator_benchmark_result result;
+	memset(&result, 0, sizeof(result));
+
+	DCPU *cpu = self.factory([self imageOfWorkload:name]);
+	Memory *memory = cpu.memory;
+
+	uint64_t allocations = benchmarkAllocationCount();
+	uint64_t start = benchmarkNow();
+
+	while(result.cycles < self.cycleBudget)
+	{
+		uint16_t instruction = (uint16_t) [memory peekInstructionAtProgramCounter];
+		BOOL skipped = cpu.ignoreNextInstruction;
+
+		if(![cpu executeInstruction])
+		{
+			result.halted = YES;
+			break;
+		}
+
+		result.instructions++;
+		result.cycles += (uint64_t) (skipped ? FAILED_TEST_CYCLES : cyclesForInstruction(instruction));
+	}
+
+	result.nanoseconds = benchmarkNow() - start;
+	result.allocations = benchmarkAllocationCount() - allocations;
+
+	return result;
+}
+
+- (NSDictionary *)reportOfWorkload:(NSString *)name result:(struct emulator_benchmark_result)result
+{
+	double seconds = MAX(result.nanoseconds, 1) / 1e9;
+	BOOL counted = benchmarkAllocationCounterInstalled();
+
+	return @{
+		@"name": name,
+		@"instructions": @(result.instructions),
+		@"cycles": @(result.cycles),
+		@"seconds": @(seconds),
+		@"instructions_per_second": @(result.instructions / seconds),
+		@"cycles_per_second": @(result.cycles / seconds),
+		@"allocations": counted ? @(result.allocations) : (id) [NSNull null],
+		@"allocations_per_instruction": counted ? @(result.instructions == 0 ? 0 : (double) result.allocations / result.instructions) : (id) [NSNull null],
+		@"halted": @(result.halted)
+	};
+}
+
+- (NSData *)runAllAsJSON
+{
+	NSMutableArray *reports = [NSMutableArray array];
+
+	for(NSString *name in [EmulatorBenchmark workloadNames])
+	{
+		[reports addObject:[self reportOfWorkload:name result:[self runWorkload:name]]];
+	}
+
+	NSDictionary *report = @{
+		@"engine": self.engineName,
+		@"cycle_budget": @(self.cycleBudget),
+		@"workloads": reports
+	};
+
+	return [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:NULL];
+}
+
+@end
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "EmulatorBenchmarkTests.h"
+#import "EmulatorBenchmark.h"
+#import "BenchmarkSupport.h"
+
+// Full runs only happen when DCPU16_BENCHMARK is set; DCPU16_BENCHMARK_OUTPUT names a
+// file for the JSON report, otherwise it is logged.
+#define SMOKE_CYCLES 2000
+
+@implementation EmulatorBenchmarkTests
+
+- (void)testRunWorkloadCalledWithEveryWorkloadRunsTheWholeBudget
+{
+	EmulatorBenchmark *benchmark = [[EmulatorBenchmark alloc] init];
+	benchmark.cycleBudget = SMOKE_CYCLES;
+
+	for(NSString *name in [EmulatorBenchmark workloadNames])
+	{
+		struct emulator_benchmark_result result = [benchmark runWorkload:name];
+
+		STAssertFalse(result.halted, @"%@", name);
+		STAssertTrue(result.cycles >= SMOKE_CYCLES, @"%@", name);
+		STAssertTrue(result.instructions > 0, @"%@", name);
+	}
+}
+
+- (void)testImageOfWorkloadCalledTwiceAssemblesOnce
+{
+	EmulatorBenchmark *benchmark = [[EmulatorBenchmark alloc] init];
+
+	STAssertTrue([benchmark imageOfWorkload:@"sieve"] == [benchmark imageOfWorkload:@"sieve"], nil);
+}
+
+- (void)testRunAllAsJSONReportsEveryWorkload
+{
+	EmulatorBenchmark *benchmark = [[EmulatorBenchmark alloc] init];
+	benchmark.cycleBudget = SMOKE_CYCLES;
+
+	NSDictionary *report = [NSJSONSerialization JSONObjectWithData:[benchmark runAllAsJSON] options:0 error:NULL];
+
+	STAssertEqualObjects([report objectForKey:@"engine"], @"DCPU", nil);
+	STAssertEqualObjects([[report objectForKey:@"workloads"] valueForKey:@"name"], [EmulatorBenchmark workloadNames], nil);
+	STAssertNotNil([[[report objectForKey:@"workloads"] objectAtIndex:0] objectForKey:@"cycles_per_second"], nil);
+}
+
+- (void)testReportOfWorkloadWithoutAllocationCounterLeavesAllocationsNull
+{
+	if(benchmarkAllocationCounterInstalled())
+	{
+		return;
+	}
+
+	EmulatorBenchmark *benchmark = [[EmulatorBenchmark alloc] init];
+	benchmark.cycleBudget = SMOKE_CYCLES;
+
+	NSDictionary *report = [benchmark reportOfWorkload:@"fibonacci" result:[benchmark runWorkload:@"fibonacci"]];
+
+	STAssertEqualObjects([report objectForKey:@"allocations"], [NSNull null], nil);
+	STAssertEqualObjects([report objectForKey:@"allocations_per_instruction"], [NSNull null], nil);
+}
+
+- (void)testRunStandardWorkloads
+{
+	NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+
+	if([environment objectForKey:@"DCPU16_BENCHMARK"] == nil)
+	{
+		return;
+	}
+
+	benchmarkInstallAllocationCounter();
+
+	NSData *json = [[[EmulatorBenchmark alloc] init] runAllAsJSON];
+	NSString *output = [environment objectForKey:@"DCPU16_BENCHMARK_OUTPUT"];
+
+	if(output != nil)
+	{
+		STAssertTrue([json writeToFile:output atomically:YES], nil);
+	}
+	else
+	{
+		NSLog(@"%@", [[NSString alloc] initWithData:json encoding:NSUTF8StringEncoding]);
+	}
+}
+
+@end
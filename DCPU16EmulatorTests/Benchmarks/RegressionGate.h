@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "BenchmarkSupport.h"
+
+#define REGRESSION_GATE_WARMUPS 2
+#define REGRESSION_GATE_REPETITIONS 10
+#define REGRESSION_GATE_THROUGHPUT_THRESHOLD 0.05
+#define REGRESSION_GATE_ALLOCATION_THRESHOLD 0.01
+#define REGRESSION_GATE_ASSEMBLER_LINES 10000
+
+// One repetition of a benchmark, as metric name to value.
+typedef NSDictionary *(^benchmarkRun)(void);
+
+// Repeats benchmarks after warm-up runs and compares each metric against the baseline
+// stored for this machine. Metrics ending in "_per_second" are throughputs, where lower
+// is worse; every other metric is a count, such as allocations, where higher is worse.
+// A metric regresses when it is worse than the baseline by more than its threshold even
+// after allowing for the 95% confidence intervals of both runs. Allocation metrics are
+// only measured while the allocation counter is installed.
+@interface RegressionGate : NSObject
+
+@property(nonatomic, assign) NSUInteger warmups;
+@property(nonatomic, assign) NSUInteger repetitions;
+@property(nonatomic, assign) double throughputThreshold;
+@property(nonatomic, assign) double allocationThreshold;
+
+@property(nonatomic, copy, readonly) NSString *machineIdentifier;
+@property(nonatomic, copy, readonly) NSString *baselinePath;
+
+// Hardware model and host name, e.g. "MacBookPro8,2-buildbox".
++ (NSString *)currentMachineIdentifier;
+
+- (id)initWithBaselineDirectory:(NSString *)directory;
+
+- (id)initWithBaselineDirectory:(NSString *)directory machineIdentifier:(NSString *)machine;
+
+// Metrics are recorded as "benchmark.metric".
+- (void)measure:(NSString *)benchmark run:(benchmarkRun)run;
+
+- (void)addSample:(double)value forMetric:(NSString *)metric;
+
+- (struct benchmark_summary)summaryOfMetric:(NSString *)metric;
+
+// Every EmulatorBenchmark workload on each engine, and the assembler pipeline over
+// REGRESSION_GATE_ASSEMBLER_LINES generated lines.
+- (void)measureEmulatorBenchmarks:(NSArray *)engines;
+
+- (void)measureAssemblerBenchmark;
+
+- (BOOL)hasBaseline;
+
+- (BOOL)saveBaseline:(NSError **)error;
+
+// NO if any metric regressed. The report has one line per metric, regressions first.
+- (BOOL)compareWithBaselineReport:(NSString **)report;
+
+@end
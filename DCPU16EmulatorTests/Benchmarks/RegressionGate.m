@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "RegressionGate.h"
+#import "EmulatorBenchmark.h"
+#import "AssemblerBenchmark.h"
+#import <sys/sysctl.h>
+
+@interface RegressionGate ()
+
+@property(nonatomic, copy, readwrite) NSString *machineIdentifier;
+@property(nonatomic, copy, readwrite) NSString *baselinePath;
+@property(nonatomic, strong) NSMutableDictionary *samples;
+
+@end
+
+@implementation RegressionGate
+
+@synthesize warmups;
+@synthesize repetitions;
+@synthesize throughputThreshold;
+@synthesize allocationThreshold;
+@synthesize machineIdentifier;
+@synthesize baselinePath;
+@synthesize samples;
+
++ (NSString *)sysctlString:(const char *)name
+{
+	size_t size = 0;
+
+	if(sysctlbyname(name, NULL, &size, NULL, 0) != 0 || size == 0)
+	{
+		return nil;
+	}
+
+	char *value = malloc(size);
+	sysctlbyname(name, value, &size, NULL, 0);
+
+	NSString *string = [NSString stringWithUTF8String:value];
+	free(value);
+
+	return string;
+}
+
++ (NSString *)currentMachineIdentifier
+{
+	NSString *model = [self sysctlString:"hw.model"];
+
+	if(model == nil)
+	{
+		model = [self sysctlString:"hw.machine"];
+	}
+
+	NSString *identifier = [NSString stringWithFormat:@"%@-%@", model, [[NSProcessInfo processInfo] hostName]];
+	NSCharacterSet *unsafe = [[NSCharacterSet characterSetWithCharactersInString:
+			@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789,.-_"] invertedSet];
+
+	return [[identifier componentsSeparatedByCharactersInSet:unsafe] componentsJoinedByString:@"_"];
+}
+
+- (id)initWithBaselineDirectory:(NSString *)directory
+{
+	return [self initWithBaselineDirectory:directory machineIdentifier:[RegressionGate currentMachineIdentifier]];
+}
+
+- (id)initWithBaselineDirectory:(NSString *)directory machineIdentifier:(NSString *)machine
+{
+	self = [super init];
+
+	machineIdentifier = [machine copy];
+	baselinePath = [[directory stringByAppendingPathComponent:machine] stringByAppendingPathExtension:@"json"];
+	samples = [[NSMutableDictionary alloc] init];
+
+	warmups = REGRESSION_GATE_WARMUPS;
+	repetitions = REGRESSION_GATE_REPETITIONS;
+	throughputThreshold = REGRESSION_GATE_THROUGHPUT_THRESHOLD;
+	allocationThreshold = REGRESSION_GATE_ALLOCATION_THRESHOLD;
+
+	return self;
+}
+
+#pragma mark - Measuring
+
+- (void)measure:(NSString *)benchmark run:(benchmarkRun)run
+{
+	for(NSUInteger i = 0; i < self.warmups; i++)
+	{
+		@autoreleasepool
+		{
+			run();
+		}
+	}
+
+	for(NSUInteger i = 0; i < self.repetitions; i++)
+	{
+		@autoreleasepool
+		{
+			NSDictionary *values = run();
+
+			for(NSString *metric in values)
+			{
+				[self addSample:[[values objectForKey:metric] doubleValue]
+					  forMetric:[NSString stringWithFormat:@"%@.%@", benchmark, metric]];
+			}
+		}
+	}
+}
+
+- (void)addSample:(double)value forMetric:(NSString *)metric
+{
+	NSMutableArray *values = [self.samples objectForKey:metric];
+
+	if(values == nil)
+	{
+		values = [NSMutableArray array];
+		[self.samples setObject:values forKey:metric];
+	}
+
+	[values addObject:[NSNumber numberWithDouble:value]];
+}
+
+- (struct benchmark_summary)summaryOfMetric:(NSString *)metric
+{
+	NSArray *values = [self.samples objectForKey:metric];
+	NSUInteger count = [values count];
+	double *buffer = malloc(MAX(count, 1) * sizeof(double));
+
+	for(NSUInteger i = 0; i < count; i++)
+	{
+		buffer[i] = [[values objectAtIndex:i] doubleValue];
+	}
+
+	struct benchmark_summary summary = benchmarkSummarize(buffer, count);
+	free(buffer);
+
+	return summary;
+}
+
+- (void)measureEmulatorBenchmarks:(NSArray *)engines
+{
+	for(EmulatorBenchmark *engine in engines)
+	{
+		for(NSString *workload in [EmulatorBenchmark workloadNames])
+		{
+			[self measure:[NSString stringWithFormat:@"emulator.%@.%@", engine.engineName, workload] run:^NSDictionary *
+			{
+				struct emulator_benchmark_result result = [engine runWorkload:workload];
+				NSDictionary *report = [engine reportOfWorkload:workload result:result];
+
+				return [self metrics:@[@"cycles_per_second", @"instructions_per_second", @"allocations_per_instruction"]
+						  fromReport:report];
+			}];
+		}
+	}
+}
+
+- (void)measureAssemblerBenchmark
+{
+	AssemblerBenchmark *benchmark = [[AssemblerBenchmark alloc] init];
+
+	[self measure:@"assembler" run:^NSDictionary *
+	{
+		NSDictionary *report = [benchmark reportOfResult:[benchmark runWithLineCount:REGRESSION_GATE_ASSEMBLER_LINES]];
+
+		return [self metrics:@[@"lex_lines_per_second", @"parse_lines_per_second", @"assemble_lines_per_second",
+							   @"program_lines_per_second", @"allocations"]
+				  fromReport:report];
+	}];
+}
+
+// Null report fields, such as allocations without the counter, are left out rather
+// than compared as zero.
+- (NSDictionary *)metrics:(NSArray *)names fromReport:(NSDictionary *)report
+{
+	NSMutableDictionary *metrics = [NSMutableDictionary dictionary];
+
+	for(NSString *name in names)
+	{
+		id value = [report objectForKey:name];
+
+		if(value != nil && value != [NSNull null])
+		{
+			[metrics setObject:value forKey:name];
+		}
+	}
+
+	return metrics;
+}
+
+#pragma mark - Baselines
+
+- (NSDictionary *)baselineMetrics
+{
+	NSData *data = [NSData dataWithContentsOfFile:self.baselinePath];
+
+	if(data == nil)
+	{
+		return nil;
+	}
+
+	return [[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] objectForKey:@"metrics"];
+}
+
+- (BOOL)hasBaseline
+{
+	return [self baselineMetrics] != nil;
+}
+
+- (BOOL)saveBaseline:(NSError **)error
+{
+	NSMutableDictionary *metrics = [NSMutableDictionary dictionary];
+
+	for(NSString *metric in self.samples)
+	{
+		struct benchmark_summary summary = [self summaryOfMetric:metric];
+
+		[metrics setObject:@{
+			@"count": @(summary.count),
+			@"mean": @(summary.mean),
+			@"standard_deviation": @(summary.standardDeviation),
+			@"confidence": @(summary.confidence)
+		} forKey:metric];
+	}
+
+	NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"machine": self.machineIdentifier, @"metrics": metrics}
+												   options:NSJSONWritingPrettyPrinted
+													 error:error];
+
+	if(data == nil)
+	{
+		return NO;
+	}
+
+	[[NSFileManager defaultManager] createDirectoryAtPath:[self.baselinePath stringByDeletingLastPathComponent]
+							  withIntermediateDirectories:YES
+											   attributes:nil
+													error:NULL];
+
+	return [data writeToFile:self.baselinePath options:NSDataWritingAtomic error:error];
+}
+
+- (BOOL)compareWithBaselineReport:(NSString **)report
+{
+	NSDictionary *baseline = [self baselineMetrics];
+	NSMutableArray *regressions = [NSMutableArray array];
+	NSMutableArray *lines = [NSMutableArray array];
+
+	if(baseline == nil)
+	{
+		if(report != NULL)
+		{
+			*report = [NSString stringWithFormat:@"No baseline for %@ at %@\n", self.machineIdentifier, self.baselinePath];
+		}
+
+		return YES;
+	}
+
+	for(NSString *metric in [[self.samples allKeys] sortedArrayUsingSelector:@selector(compare:)])
+	{
+		struct benchmark_summary now = [self summaryOfMetric:metric];
+		NSDictionary *before = [baseline objectForKey:metric];
+
+		if(before == nil)
+		{
+			[lines addObject:[NSString stringWithFormat:@"new       %@: %.4g +/- %.2g", metric, now.mean, now.confidence]];
+			continue;
+		}
+
+		double baselineMean = [[before objectForKey:@"mean"] doubleValue];
+		double baselineConfidence = [[before objectForKey:@"confidence"] doubleValue];
+		double slack = sqrt(baselineConfidence * baselineConfidence + now.confidence * now.confidence);
+		double change = baselineMean == 0 ? 0 : (now.mean - baselineMean) / baselineMean * 100;
+		BOOL regressed;
+
+		if([metric hasSuffix:@"_per_second"])
+		{
+			regressed = baselineMean * (1 - self.throughputThreshold) - now.mean > slack;
+		}
+		else
+		{
+			regressed = now.mean - baselineMean * (1 + self.allocationThreshold) > slack;
+		}
+
+		NSString *line = [NSString stringWithFormat:@"%@ %@: baseline %.4g +/- %.2g, now %.4g +/- %.2g (%+.1f%%)",
+													regressed ? @"REGRESSED" : @"ok       ",
+													metric, baselineMean, baselineConfidence, now.mean, now.confidence, change];
+
+		[(regressed ? regressions : lines) addObject:line];
+	}
+
+	for(NSString *metric in [[baseline allKeys] sortedArrayUsingSelector:@selector(compare:)])
+	{
+		if([self.samples objectForKey:metric] == nil)
+		{
+			[lines addObject:[NSString stringWithFormat:@"missing   %@", metric]];
+		}
+	}
+
+	if(report != NULL)
+	{
+		NSMutableString *text = [NSMutableString stringWithFormat:@"%u of %u metrics regressed against %@\n",
+																  (unsigned) [regressions count], (unsigned) [self.samples count], self.baselinePath];
+
+		for(NSString *line in [regressions arrayByAddingObjectsFromArray:lines])
+		{
+			[text appendFormat:@"%@\n", line];
+		}
+
+		*report = text;
+	}
+
+	return [regressions count] == 0;
+}
+
+@end
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "RegressionGateTests.h"
+#import "RegressionGate.h"
+#import "EmulatorBenchmark.h"
+
+// The full gate only runs when DCPU16_BENCHMARK is set. Baselines are kept in
+// DCPU16_BENCHMARK_BASELINES, ~/.dcpu16-benchmarks by default, and are recorded on the
+// first run for a machine or whenever DCPU16_BENCHMARK_UPDATE_BASELINE is set.
+@interface RegressionGateTests ()
+
+@property(nonatomic, copy) NSString *directory;
+
+@end
+
+@implementation RegressionGateTests
+
+@synthesize directory;
+
+- (void)setUp
+{
+	self.directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSProcessInfo processInfo] globallyUniqueString]];
+}
+
+- (void)tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtPath:self.directory error:NULL];
+}
+
+- (RegressionGate *)gateWithThroughput:(double)throughput allocations:(double)allocations
+{
+	RegressionGate *gate = [[RegressionGate alloc] initWithBaselineDirectory:self.directory machineIdentifier:@"test"];
+
+	for(int i = 0; i < 5; i++)
+	{
+		[gate addSample:throughput + (i % 2) forMetric:@"emulator.fib.cycles_per_second"];
+		[gate addSample:allocations forMetric:@"assembler.allocations"];
+	}
+
+	return gate;
+}
+
+- (void)testBenchmarkSummarizeReturnsMeanAndConfidenceInterval
+{
+	double values[] = {1, 2, 3, 4, 5};
+	struct benchmark_summary summary = benchmarkSummarize(values, 5);
+
+	STAssertEquals(summary.count, (NSUInteger)5, nil);
+	STAssertEqualsWithAccuracy(summary.mean, 3.0, 1e-9, nil);
+	STAssertEqualsWithAccuracy(summary.standardDeviation, 1.5811, 1e-4, nil);
+	STAssertEqualsWithAccuracy(summary.confidence, 1.9629, 1e-4, nil);
+}
+
+- (void)testMeasureCalledWithWarmupsRecordsOnlyRepetitions
+{
+	RegressionGate *gate = [[RegressionGate alloc] initWithBaselineDirectory:self.directory machineIdentifier:@"test"];
+	gate.warmups = 2;
+	gate.repetitions = 3;
+
+	__block int runs = 0;
+
+	[gate measure:@"counter" run:^NSDictionary *
+	{
+		runs++;
+		return @{@"runs": @(runs)};
+	}];
+
+	struct benchmark_summary summary = [gate summaryOfMetric:@"counter.runs"];
+
+	STAssertEquals(runs, 5, nil);
+	STAssertEquals(summary.count, (NSUInteger)3, nil);
+	STAssertEqualsWithAccuracy(summary.mean, 4.0, 1e-9, nil);
+}
+
+- (void)testCompareWithBaselineReportCalledWithoutBaselinePasses
+{
+	NSString *report;
+	RegressionGate *gate = [self gateWithThroughput:100 allocations:10];
+
+	STAssertFalse([gate hasBaseline], nil);
+	STAssertTrue([gate compareWithBaselineReport:&report], nil);
+	STAssertTrue([report hasPrefix:@"No baseline for test"], nil);
+}
+
+- (void)testCompareWithBaselineReportCalledWithinThresholdPasses
+{
+	NSString *report;
+	STAssertTrue([[self gateWithThroughput:100 allocations:10] saveBaseline:NULL], nil);
+
+	STAssertTrue([[self gateWithThroughput:97 allocations:10] compareWithBaselineReport:&report], @"%@", report);
+}
+
+- (void)testCompareWithBaselineReportCalledWithSlowerThroughputFails
+{
+	NSString *report;
+	STAssertTrue([[self gateWithThroughput:100 allocations:10] saveBaseline:NULL], nil);
+
+	STAssertFalse([[self gateWithThroughput:80 allocations:10] compareWithBaselineReport:&report], nil);
+	STAssertTrue([report hasPrefix:@"1 of 2 metrics regressed"], @"%@", report);
+	STAssertTrue([report rangeOfString:@"REGRESSED emulator.fib.cycles_per_second"].location != NSNotFound, @"%@", report);
+}
+
+- (void)testCompareWithBaselineReportCalledWithMoreAllocationsFails
+{
+	NSString *report;
+	STAssertTrue([[self gateWithThroughput:100 allocations:10] saveBaseline:NULL], nil);
+
+	STAssertFalse([[self gateWithThroughput:100 allocations:11] compareWithBaselineReport:&report], nil);
+	STAssertTrue([report rangeOfString:@"REGRESSED assembler.allocations"].location != NSNotFound, @"%@", report);
+}
+
+- (void)testRegressionGate
+{
+	NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+
+	if([environment objectForKey:@"DCPU16_BENCHMARK"] == nil)
+	{
+		return;
+	}
+
+	if(!benchmarkInstallAllocationCounter())
+	{
+		NSLog(@"Allocation metrics are skipped without the allocation counter");
+	}
+
+	NSString *baselines = [environment objectForKey:@"DCPU16_BENCHMARK_BASELINES"];
+
+	if(baselines == nil)
+	{
+		baselines = [NSHomeDirectory() stringByAppendingPathComponent:@".dcpu16-benchmarks"];
+	}
+
+	RegressionGate *gate = [[RegressionGate alloc] initWithBaselineDirectory:baselines];
+
+	[gate measureEmulatorBenchmarks:@[[[EmulatorBenchmark alloc] init]]];
+	[gate measureAssemblerBenchmark];
+
+	if(![gate hasBaseline] || [environment objectForKey:@"DCPU16_BENCHMARK_UPDATE_BASELINE"] != nil)
+	{
+		NSError *error;
+		STAssertTrue([gate saveBaseline:&error], @"%@", error);
+		NSLog(@"Recorded baseline %@", gate.baselinePath);
+		return;
+	}
+
+	NSString *report;
+	BOOL passed = [gate compareWithBaselineReport:&report];
+
+	NSLog(@"%@", report);
+	STAssertTrue(passed, @"%@", report);
+}
+
+@end
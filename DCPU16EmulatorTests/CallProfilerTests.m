@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "CallProfilerTests.h"
+#import "CallProfiler.h"
+
+// SET A, 1 / JSR next word / SET PC, POP
+#define SET_A_1 0x8401
+#define JSR_NEXT_WORD 0x7C10
+#define RETURN 0x61C1
+
+@implementation CallProfilerTests
+
+- (CallProfiler *)profilerWithLabels
+{
+	CallProfiler *profiler = [[CallProfiler alloc] initWithEntryAddress:0];
+
+	[profiler addLabel:@"main" atAddress:0];
+	[profiler addLabel:@"f" atAddress:0x10];
+	[profiler addLabel:@"g" atAddress:0x20];
+
+	return profiler;
+}
+
+- (void)runNestedCallsWithProfiler:(CallProfiler *)profiler
+{
+	[profiler recordInstruction:SET_A_1 skipped:NO nextProgramCounter:1];
+	[profiler recordInstruction:JSR_NEXT_WORD skipped:NO nextProgramCounter:0x10];
+	[profiler recordInstruction:SET_A_1 skipped:NO nextProgramCounter:0x11];
+	[profiler recordInstruction:JSR_NEXT_WORD skipped:NO nextProgramCounter:0x20];
+	[profiler recordInstruction:SET_A_1 skipped:NO nextProgramCounter:0x21];
+	[profiler recordInstruction:RETURN skipped:NO nextProgramCounter:0x13];
+	[profiler recordInstruction:RETURN skipped:NO nextProgramCounter:0x3];
+	[profiler recordInstruction:SET_A_1 skipped:NO nextProgramCounter:0x4];
+}
+
+- (const struct function_profile *)function:(uint16_t)address ofProfiler:(CallProfiler *)profiler
+{
+	for(NSUInteger index = 0; index < profiler.functionCount; index++)
+	{
+		if(profiler.functions[index].address == address)
+		{
+			return &profiler.functions[index];
+		}
+	}
+
+	return NULL;
+}
+
+- (void)testRecordInstructionCalledWithNestedCallsChargesEachFunction
+{
+	CallProfiler *profiler = [self profilerWithLabels];
+	[self runNestedCallsWithProfiler:profiler];
+
+	STAssertEquals(profiler.cycles, (uint64_t)12, nil);
+	STAssertEquals(profiler.depth, (NSUInteger)0, nil);
+	STAssertEquals(profiler.functionCount, (NSUInteger)3, nil);
+
+	STAssertEquals([self function:0 ofProfiler:profiler]->inclusiveCycles, (uint64_t)12, nil);
+	STAssertEquals([self function:0 ofProfiler:profiler]->exclusiveCycles, (uint64_t)5, nil);
+	STAssertEquals([self function:0x10 ofProfiler:profiler]->inclusiveCycles, (uint64_t)7, nil);
+	STAssertEquals([self function:0x10 ofProfiler:profiler]->exclusiveCycles, (uint64_t)5, nil);
+	STAssertEquals([self function:0x20 ofProfiler:profiler]->inclusiveCycles, (uint64_t)2, nil);
+	STAssertEquals([self function:0x20 ofProfiler:profiler]->calls, (uint32_t)1, nil);
+}
+
+- (void)testFoldedStacksCalledAfterNestedCallsReturnsSymbolizedPaths
+{
+	CallProfiler *profiler = [self profilerWithLabels];
+	[self runNestedCallsWithProfiler:profiler];
+
+	STAssertEqualObjects([profiler foldedStacks], @"main 5\nmain;f 5\nmain;f;g 2\n", nil);
+}
+
+- (void)testRecordInstructionCalledWithRecursionCountsInclusiveCyclesOnce
+{
+	CallProfiler *profiler = [self profilerWithLabels];
+
+	[profiler recordInstruction:JSR_NEXT_WORD skipped:NO nextProgramCounter:0x10];
+	[profiler recordInstruction:JSR_NEXT_WORD skipped:NO nextProgramCounter:0x10];
+	[profiler recordInstruction:RETURN skipped:NO nextProgramCounter:0x12];
+	[profiler recordInstruction:RETURN skipped:NO nextProgramCounter:0x2];
+
+	const struct function_profile *f = [self function:0x10 ofProfiler:profiler];
+
+	STAssertEquals(f->calls, (uint32_t)2, nil);
+	STAssertEquals(f->exclusiveCycles, (uint64_t)5, nil);
+	STAssertEquals(f->inclusiveCycles, (uint64_t)5, nil);
+}
+
+- (void)testRecordInstructionCalledWithSampleIntervalChargesWholeSamples
+{
+	CallProfiler *profiler = [self profilerWithLabels];
+	profiler.sampleInterval = 4;
+	[self runNestedCallsWithProfiler:profiler];
+
+	STAssertEquals([self function:0 ofProfiler:profiler]->inclusiveCycles, (uint64_t)12, nil);
+	STAssertEquals([self function:0 ofProfiler:profiler]->exclusiveCycles, (uint64_t)8, nil);
+	STAssertEquals([self function:0x10 ofProfiler:profiler]->exclusiveCycles, (uint64_t)4, nil);
+	STAssertEqualObjects([profiler foldedStacks], @"main 8\nmain;f 4\n", nil);
+}
+
+- (void)testRecordInstructionCalledWithSkippedCallDoesNotPush
+{
+	CallProfiler *profiler = [self profilerWithLabels];
+
+	[profiler recordInstruction:JSR_NEXT_WORD skipped:YES nextProgramCounter:0x2];
+
+	STAssertEquals(profiler.depth, (NSUInteger)0, nil);
+	STAssertEquals(profiler.cycles, (uint64_t)1, nil);
+}
+
+@end
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "ControlFlowAnalyzerTests.h"
+#import "ControlFlowAnalyzer.h"
+#import "Assembler.h"
+#import "StatmentTable.h"
+#import "AssemblyTestSupport.h"
+
+@implementation ControlFlowAnalyzerTests
+
+- (ControlFlowAnalyzer *)analyzerForSource:(NSString *)source
+{
+	StatmentTable *table = [AssemblyTestSupport tableOfSource:source];
+	Assembler *assembler = [AssemblyTestSupport assemblerOfTable:table];
+
+	ControlFlowAnalyzer *analyzer = [[ControlFlowAnalyzer alloc] init];
+	[analyzer addLabelsFromAssembler:assembler symbols:table.symbols];
+	[analyzer analyzeImage:[assembler image]];
+
+	return analyzer;
+}
+
+- (void)testAnalyzeImageSplitsBlocksAtLabelsTestsAndJumps
+{
+	ControlFlowAnalyzer *analyzer = [self analyzerForSource:@"SET I, 10\n:loop SUB I, 1\nIFN I, 0\nSET PC, loop\n:crash SET PC, crash"];
+
+	STAssertEquals(analyzer.blockCount, (NSUInteger)4, nil);
+	STAssertEquals(analyzer.blocks[0].cycles, (uint32_t)1, nil);
+	STAssertEquals(analyzer.blocks[1].start, (uint16_t)1, nil);
+	STAssertEquals(analyzer.blocks[1].cycles, (uint32_t)4, nil);
+	STAssertEquals(analyzer.blocks[1].successors[0], 2, nil);
+	STAssertEquals(analyzer.blocks[1].successors[1], 3, nil);
+	STAssertEquals(analyzer.blocks[2].successors[0], 1, nil);
+	STAssertEquals(analyzer.blocks[3].successors[0], 3, nil);
+	STAssertEquals([analyzer blockAtAddress:2], 1, nil);
+}
+
+- (void)testAnalyzeImageSplitsBlocksAfterCallToUnknownTarget
+{
+	ControlFlowAnalyzer *analyzer = [self analyzerForSource:@"SET A, 1\nJSR A\nSET B, 1\n:end SET PC, end"];
+
+	STAssertEquals(analyzer.blockCount, (NSUInteger)3, nil);
+	STAssertEquals(analyzer.blocks[0].end, (uint32_t)2, nil);
+	STAssertTrue((analyzer.blocks[0].flags & BLOCK_CALLS) != 0, nil);
+	STAssertEquals(analyzer.blocks[0].successors[0], 1, nil);
+	STAssertEquals(analyzer.blocks[1].start, (uint16_t)2, nil);
+	STAssertEquals(analyzer.blocks[1].successors[0], 2, nil);
+}
+
+- (void)testAnalyzeImageReportsLoopCostsAndInfiniteBusyWait
+{
+	ControlFlowAnalyzer *analyzer = [self analyzerForSource:@"SET I, 10\n:loop SUB I, 1\nIFN I, 0\nSET PC, loop\n:crash SET PC, crash"];
+
+	STAssertEquals(analyzer.loopCount, (NSUInteger)2, nil);
+	STAssertEquals(analyzer.loops[0].header, 1, nil);
+	STAssertEquals(analyzer.loops[0].minCycles, (uint32_t)6, nil);
+	STAssertEquals(analyzer.loops[0].maxCycles, (uint32_t)6, nil);
+	STAssertEquals(analyzer.loops[0].flags, (uint8_t)0, nil);
+	STAssertEquals(analyzer.loops[1].header, 3, nil);
+	STAssertEquals(analyzer.loops[1].flags, (uint8_t)(LOOP_INFINITE | LOOP_BUSY_WAIT), nil);
+	STAssertTrue([[analyzer report] rangeOfString:@"loop crash: 1 blocks, 2-2 cycles per iteration, infinite, busy wait"].location != NSNotFound, nil);
+}
+
+- (void)testAnalyzeImageGivesRangeForLoopsWithSkippedInstructionsAndFlagsNoExit
+{
+	ControlFlowAnalyzer *analyzer = [self analyzerForSource:@":top IFE A, 0\nADD B, 1\nSET PC, top"];
+
+	STAssertEquals(analyzer.loopCount, (NSUInteger)1, nil);
+	STAssertEquals(analyzer.loops[0].blockCount, (uint32_t)3, nil);
+	STAssertEquals(analyzer.loops[0].minCycles, (uint32_t)5, nil);
+	STAssertEquals(analyzer.loops[0].maxCycles, (uint32_t)6, nil);
+	STAssertEquals(analyzer.loops[0].flags, (uint8_t)LOOP_INFINITE, nil);
+}
+
+- (void)testAnalyzeImageFlagsRegisterPollAsBusyWaitButNotMemoryPoll
+{
+	ControlFlowAnalyzer *registerPoll = [self analyzerForSource:@"SET A, 1\n:wait IFE A, 0\nSET PC, wait\nSET B, 1\nSET PC, POP"];
+	ControlFlowAnalyzer *memoryPoll = [self analyzerForSource:@":wait IFE [0x9000], 0\nSET PC, wait\nSET B, 1\nSET PC, POP"];
+
+	STAssertEquals(registerPoll.loops[0].flags, (uint8_t)LOOP_BUSY_WAIT, nil);
+	STAssertEquals(registerPoll.loops[0].minCycles, (uint32_t)4, nil);
+	STAssertEquals(memoryPoll.loops[0].flags, (uint8_t)0, nil);
+	STAssertEquals(memoryPoll.loops[0].minCycles, (uint32_t)5, nil);
+}
+
+- (void)testSymbolizeAddressUsesNearestPrecedingLabel
+{
+	ControlFlowAnalyzer *analyzer = [self analyzerForSource:@"SET I, 10\n:loop SUB I, 1\nIFN I, 0\nSET PC, loop\n:crash SET PC, crash"];
+
+	STAssertEqualObjects([analyzer symbolizeAddress:1], @"loop", nil);
+	STAssertEqualObjects([analyzer symbolizeAddress:3], @"loop+0x2", nil);
+	STAssertEqualObjects([analyzer symbolizeAddress:0], @"0x0000", nil);
+}
+
+@end
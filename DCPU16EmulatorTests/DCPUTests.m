@@ -70,6 +70,28 @@
 	STAssertTrue([emulator readGeneralPurposeRegisterValue:6] == 10, nil);
 }
 
+- (void)testStepCalledWithAssembledImageExecutesProgram
+{
+	NSString *code = @"SET A, 0x30\n\
+	SET [0x1000], A";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+
+	[assembler assembleStatments:p.statments];
+
+	DCPU *emulator = [[DCPU alloc] initWithImage:[assembler image]];
+
+	STAssertTrue([emulator executeInstruction], nil);
+	STAssertTrue([emulator executeInstruction], nil);
+	STAssertTrue([emulator readMemoryValueAtAddress:0x1000] == 0x30, nil);
+}
+
 - (void)testStepCalledWithSetRegisterWithHexLiteralExecutesProgram
 {
 	NSString *code = @"SET A, 0x30";
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "DisassemblerTests.h"
+#import "Disassembler.h"
+#import "AssemblyTestSupport.h"
+
+@implementation DisassemblerTests
+
+- (NSString *)textOfWords:(const uint16_t *)words count:(NSUInteger)count size:(NSUInteger *)size
+{
+	char line[DISASSEMBLY_LINE_LENGTH];
+	*size = [[[Disassembler alloc] init] disassembleWords:words count:count atAddress:0 intoBuffer:line length:sizeof(line)];
+
+	return [NSString stringWithUTF8String:line];
+}
+
+- (void)testDisassembleWordsRendersOperandForms
+{
+	uint16_t offset[] = {0x2161, 0x2000};
+	uint16_t literal[] = {0xc00d};
+	uint16_t pop[] = {0x61c1};
+	uint16_t nextWord[] = {0x7c01, 0x0030};
+	NSUInteger size;
+
+	STAssertEqualObjects([self textOfWords:offset count:2 size:&size], @"SET [0x2000+I], [A]", nil);
+	STAssertEquals(size, (NSUInteger)2, nil);
+	STAssertEqualObjects([self textOfWords:literal count:1 size:&size], @"IFN A, 0x10", nil);
+	STAssertEqualObjects([self textOfWords:pop count:1 size:&size], @"SET PC, POP", nil);
+	STAssertEqualObjects([self textOfWords:nextWord count:2 size:&size], @"SET A, 0x0030", nil);
+}
+
+- (void)testDisassembleWordsWritesDatForWordsThatWouldNotReassembleTheSame
+{
+	uint16_t shortTarget[] = {0x7dc1, 0x001a};
+	uint16_t illegal[] = {0x0000};
+	uint16_t truncated[] = {0x7c01};
+	NSUInteger size;
+
+	STAssertEqualObjects([self textOfWords:shortTarget count:2 size:&size], @"DAT 0x7DC1, 0x001A ; SET PC, 0x001A", nil);
+	STAssertEquals(size, (NSUInteger)2, nil);
+	STAssertEqualObjects([self textOfWords:illegal count:1 size:&size], @"DAT 0x0000", nil);
+	STAssertEqualObjects([self textOfWords:truncated count:1 size:&size], @"DAT 0x7C01", nil);
+	STAssertEquals(size, (NSUInteger)1, nil);
+}
+
+- (void)testDisassembleWordsTruncatesToBufferLength
+{
+	uint16_t nextWord[] = {0x7c01, 0x0030};
+	char line[8];
+
+	NSUInteger size = [[[Disassembler alloc] init] disassembleWords:nextWord count:2 atAddress:0 intoBuffer:line length:sizeof(line)];
+
+	STAssertEquals(size, (NSUInteger)2, nil);
+	STAssertEquals(strcmp(line, "SET A, "), 0, nil);
+}
+
+- (void)testSourceOfImageReassemblesToTheSameImage
+{
+	NSData *image = [AssemblyTestSupport imageOfSource:@"\
+            SET A, 0x30\n\
+            SET [0x1000], 0x20\n\
+            SUB A, [0x1000]\n\
+            IFN A, 0x10\n\
+            SET PC, crash\n\
+            SET I, 10\n\
+            SET A, 0x2000\n\
+:loop       SET [0x2000+I], [A]\n\
+            SUB I, 1\n\
+            IFN I, 0\n\
+            SET PC, loop\n\
+            SET X, 0x4\n\
+            JSR testsub\n\
+            SET PC, crash\n\
+:testsub    SHL X, 4\n\
+            SET PC, POP\n\
+            DAT 0, 0x5, 0x1234\n\
+:crash      SET PC, crash"];
+
+	NSString *source = [[[Disassembler alloc] init] sourceOfImage:image];
+
+	STAssertEqualObjects([AssemblyTestSupport imageOfSource:source], image, nil);
+}
+
+@end
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+#import "IncrementalAssemblerTests.h"
+#import "IncrementalAssembler.h"
+#import "Assembler.h"
+#import "Parser.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+#import "OperandFactory.h"
+
+@implementation IncrementalAssemblerTests
+
+- (NSData *)imageOfLines:(NSArray *)lines
+{
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:[lines componentsJoinedByString:@"\n"] withLexer:lexer];
+
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:p.statments];
+
+	return [assembler image];
+}
+
+- (NSArray *)sampleLines
+{
+	return @[
+		@"SET PC, start",
+		@"SET A, 0x30",
+		@":start SET I, 10",
+		@":loop SUB I, 1",
+		@"IFN I, 0",
+		@"SET PC, loop",
+		@"SET PC, end",
+		@":end SET B, 1"
+	];
+}
+
+- (void)testAssembleLinesCalledFirstTimeGeneratesSameImageAsAssembler
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	NSArray *changed = [assembler assembleLines:[self sampleLines]];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:[self sampleLines]], nil);
+	STAssertEquals((int)[changed count], 1, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].length, assembler.wordCount, nil);
+}
+
+- (void)testAssembleLinesCalledWithSameSizeEditReportsOnlyEditedStatment
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:[self sampleLines]];
+
+	NSMutableArray *edited = [[self sampleLines] mutableCopy];
+	[edited replaceObjectAtIndex:4 withObject:@"IFN I, 2"];
+
+	NSArray *changed = [assembler assembleLines:edited];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:edited], nil);
+	STAssertEquals((int)[changed count], 1, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].location, (NSUInteger)6, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].length, (NSUInteger)1, nil);
+}
+
+- (void)testAssembleLinesCalledWithInsertedLineShiftsLabelsAndPatchesReferences
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:[self sampleLines]];
+
+	NSUInteger oldWordCount = assembler.wordCount;
+	NSMutableArray *edited = [[self sampleLines] mutableCopy];
+	[edited insertObject:@"SET X, 0x1000" atIndex:3];
+
+	NSArray *changed = [assembler assembleLines:edited];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:edited], nil);
+	STAssertEquals(assembler.wordCount, oldWordCount + 2, nil);
+	STAssertEquals((int)[changed count], 1, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].location, (NSUInteger)5, nil);
+}
+
+- (void)testAssembleLinesCalledWithRemovedLabelLeavesReferencesUnresolved
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:[self sampleLines]];
+
+	NSMutableArray *edited = [[self sampleLines] mutableCopy];
+	[edited replaceObjectAtIndex:2 withObject:@"SET I, 10"];
+
+	NSArray *changed = [assembler assembleLines:edited];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:edited], nil);
+	STAssertEquals((int)[changed count], 2, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].location, (NSUInteger)1, nil);
+	STAssertEquals([[changed objectAtIndex:1] rangeValue].location, (NSUInteger)4, nil);
+	STAssertEquals(assembler.words[1], (uint16_t)0, nil);
+}
+
+- (void)testAssembleLinesCalledWithRemovedDuplicateLabelResolvesToRemainingDefinition
+{
+	NSArray *lines = @[@"SET A, 1", @":here SET B, 2", @"SET PC, here", @":here SET C, 3"];
+
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:lines];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:lines], nil);
+
+	NSArray *edited = [lines subarrayWithRange:NSMakeRange(0, 3)];
+	[assembler assembleLines:edited];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:edited], nil);
+	STAssertEquals(assembler.words[3], (uint16_t)1, nil);
+}
+
+- (void)testAssembleLinesCalledWithGrowingEditReturnsSortedMergedRanges
+{
+	NSArray *lines = @[@"SET PC, end", @"SET A, 1", @":end SET B, 2"];
+
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:lines];
+
+	NSArray *edited = @[@"SET PC, end", @"SET A, 0x1000", @":end SET B, 2"];
+	NSArray *changed = [assembler assembleLines:edited];
+
+	STAssertEqualObjects([assembler image], [self imageOfLines:edited], nil);
+	STAssertEquals((int)[changed count], 1, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].location, (NSUInteger)1, nil);
+	STAssertEquals([[changed objectAtIndex:0] rangeValue].length, assembler.wordCount - 1, nil);
+}
+
+- (void)testAssembleLinesCountsPipelineStatsOnlyForReassembledLines
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:[self sampleLines]];
+
+#if PIPELINE_STATS_ENABLED
+	STAssertEquals(assembler.stats.runs, (uint64_t)1, nil);
+	STAssertEquals(assembler.stats.statments, (uint64_t)8, nil);
+	STAssertTrue(assembler.stats.tokensLexed > 0, nil);
+	STAssertTrue(assembler.stats.parseTime >= assembler.stats.lexTime, nil);
+
+	[assembler resetStats];
+
+	NSMutableArray *edited = [[self sampleLines] mutableCopy];
+	[edited replaceObjectAtIndex:1 withObject:@"SET A, 0x31"];
+	[assembler assembleLines:edited];
+
+	STAssertEquals(assembler.stats.runs, (uint64_t)1, nil);
+	STAssertEquals(assembler.stats.statments, (uint64_t)1, nil);
+#else
+	STAssertEquals(assembler.stats.runs, (uint64_t)0, nil);
+#endif
+}
+
+@end
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "InstructionLoweringTests.h"
+#import "InstructionLowering.h"
+#import "IncrementalAssembler.h"
+
+@implementation InstructionLoweringTests
+
+- (Instruction *)instructionWithLabel:(NSString *)label opcode:(NSString *)opcode operand1:(NSString *)operand1 operand2:(NSString *)operand2
+{
+	Instruction *instruction = [[Instruction alloc] init];
+
+	if(label != nil)
+	{
+		[instruction assignLabel:label];
+	}
+
+	[instruction assignValue:opcode];
+	[instruction assignValue:operand1];
+
+	if(operand2 != nil)
+	{
+		[instruction assignValue:operand2];
+	}
+
+	return instruction;
+}
+
+- (NSArray *)sampleInstructions
+{
+	return @[
+		[self instructionWithLabel:nil opcode:@"SET" operand1:@"PC" operand2:@"start"],
+		[self instructionWithLabel:nil opcode:@"SET" operand1:@"A" operand2:@"0x30"],
+		[self instructionWithLabel:@":start" opcode:@"SET" operand1:@"I" operand2:@"10"],
+		[self instructionWithLabel:@":loop" opcode:@"SET" operand1:@"[0x2000+I]" operand2:@"[A]"],
+		[self instructionWithLabel:nil opcode:@"SUB" operand1:@"I" operand2:@"1"],
+		[self instructionWithLabel:nil opcode:@"IFN" operand1:@"I" operand2:@"0"],
+		[self instructionWithLabel:nil opcode:@"SET" operand1:@"PC" operand2:@"loop"],
+		[self instructionWithLabel:nil opcode:@"JSR" operand1:@"end" operand2:nil],
+		[self instructionWithLabel:@":end" opcode:@"set" operand1:@"[0x1000]" operand2:@"POP"]
+	];
+}
+
+- (NSArray *)sampleLines
+{
+	return @[
+		@"SET PC, start",
+		@"SET A, 0x30",
+		@":start SET I, 10",
+		@":loop SET [0x2000+I], [A]",
+		@"SUB I, 1",
+		@"IFN I, 0",
+		@"SET PC, loop",
+		@"JSR end",
+		@":end SET [0x1000], POP"
+	];
+}
+
+- (NSData *)imageOfInstructions:(NSArray *)instructions
+{
+	InstructionLowering *lowering = [[InstructionLowering alloc] init];
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+
+	[assembler assembleLines:instructions lowering:^Statment *(id line)
+	{
+		return [lowering statmentForInstruction:line];
+	}];
+
+	return [assembler image];
+}
+
+- (void)testLoweredInstructionsAssembleToSameImageAsSourceLines
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:[self sampleLines]];
+
+	STAssertEqualObjects([self imageOfInstructions:[self sampleInstructions]], [assembler image], nil);
+}
+
+- (void)testStatmentForInstructionClassifiesOperandsLikeTheLexer
+{
+	InstructionLowering *lowering = [[InstructionLowering alloc] init];
+	Statment *statment = [lowering statmentForInstruction:[self instructionWithLabel:@":here" opcode:@"SET" operand1:@"[0x2000+I]" operand2:@"there"]];
+
+	STAssertEqualObjects(statment.label, @":here", nil);
+	STAssertTrue(statment.opcode == OP_SET, nil);
+	STAssertTrue([statment.firstOperand operandType] == O_INDIRECT_NEXT_WORD_OFFSET, nil);
+	STAssertEquals(statment.firstOperand.nextWord, (uint16_t) 0x2000, nil);
+	STAssertEqualObjects(statment.secondOperand.label, @"there", nil);
+}
+
+- (void)testStatmentForInstructionLowersDataLikeTheParser
+{
+	IncrementalAssembler *assembler = [[IncrementalAssembler alloc] init];
+	[assembler assembleLines:@[@":data DAT \"Hi\", 0x30", @"DAT 7"]];
+
+	NSArray *instructions = @[
+		[self instructionWithLabel:@":data" opcode:@"DAT" operand1:@"\"Hi\"" operand2:@"0x30"],
+		[self instructionWithLabel:nil opcode:@"DAT" operand1:@"7" operand2:nil]
+	];
+
+	STAssertEqualObjects([self imageOfInstructions:instructions], [assembler image], nil);
+}
+
+- (void)testStatmentForInstructionThrowsForUnrecognizedDataOperand
+{
+	InstructionLowering *lowering = [[InstructionLowering alloc] init];
+
+	STAssertThrows([lowering statmentForInstruction:[self instructionWithLabel:nil opcode:@"DAT" operand1:@"1" operand2:@"loop"]], nil);
+	STAssertThrows([lowering statmentForInstruction:[self instructionWithLabel:nil opcode:@"DAT" operand1:@"\"a\"b\"" operand2:nil]], nil);
+}
+
+- (void)testStatmentForInstructionThrowsForUnrecognizedOperand
+{
+	InstructionLowering *lowering = [[InstructionLowering alloc] init];
+
+	STAssertThrows([lowering statmentForInstruction:[self instructionWithLabel:nil opcode:@"SET" operand1:@"A" operand2:@"[B+C]"]], nil);
+	STAssertThrows([lowering statmentForInstruction:[self instructionWithLabel:nil opcode:@"SET" operand1:@"A" operand2:@"1-2"]], nil);
+}
+
+@end
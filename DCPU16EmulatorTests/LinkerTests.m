@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "LinkerTests.h"
+#import "Linker.h"
+#import "ObjectFile.h"
+#import "Assembler.h"
+#import "StatmentTable.h"
+#import "AssemblyTestSupport.h"
+#import "Memory.h"
+
+@implementation LinkerTests
+
+- (ObjectFile *)objectOfSource:(NSString *)source
+{
+	StatmentTable *table = [AssemblyTestSupport tableOfSource:source];
+	Assembler *assembler = [AssemblyTestSupport assemblerOfTable:table];
+
+	return [[ObjectFile alloc] initWithAssembler:assembler symbols:table.symbols];
+}
+
+- (NSString *)programSource
+{
+	return @"SET A, 4\nSET PC, lib\n:back SET B, A";
+}
+
+- (NSString *)librarySource
+{
+	return @":lib SET A, 5\n:spin SUB A, 1\nIFN A, 0\nSET PC, spin\nSET PC, back";
+}
+
+- (void)testLinkAtBaseAddressCalledWithZeroMatchesSingleAssembly
+{
+	Linker *linker = [[Linker alloc] init];
+	[linker addObject:[self objectOfSource:[self programSource]]];
+	[linker addObject:[self objectOfSource:[self librarySource]]];
+
+	NSData *image = [AssemblyTestSupport imageOfSource:[NSString stringWithFormat:@"%@\n%@", [self programSource], [self librarySource]]];
+
+	STAssertEqualObjects([linker linkAtBaseAddress:0], image, nil);
+	STAssertEquals([linker addressOfLabel:@"lib"], 4, nil);
+	STAssertEquals([linker addressOfLabel:@"back"], 3, nil);
+}
+
+- (void)testLinkAtBaseAddressRelocatesLocalAndImportedLabels
+{
+	Linker *linker = [[Linker alloc] init];
+	[linker addObject:[self objectOfSource:[self programSource]]];
+	[linker addObject:[self objectOfSource:[self librarySource]]];
+
+	NSData *image = [linker linkAtBaseAddress:0x100];
+	const uint16_t *words = [image bytes];
+
+	STAssertEquals(words[2], (uint16_t)0x104, nil);
+	STAssertEquals(words[8], (uint16_t)0x105, nil);
+	STAssertEquals(words[10], (uint16_t)0x103, nil);
+	STAssertEquals([linker baseAddressOfObjectAtIndex:1], (NSUInteger)0x104, nil);
+}
+
+- (void)testLinkAtBaseAddressCalledWithMissingImportThrows
+{
+	Linker *linker = [[Linker alloc] init];
+	[linker addObject:[self objectOfSource:[self programSource]]];
+
+	STAssertThrows([linker linkAtBaseAddress:0], nil);
+}
+
+- (void)testLinkAtBaseAddressCalledWithDuplicateSymbolThrows
+{
+	Linker *linker = [[Linker alloc] init];
+	[linker addObject:[self objectOfSource:[self librarySource]]];
+	[linker addObject:[self objectOfSource:[self librarySource]]];
+
+	STAssertThrows([linker linkAtBaseAddress:0], nil);
+}
+
+- (void)testObjectFileDataRoundTripsThroughInitWithData
+{
+	ObjectFile *object = [self objectOfSource:[self librarySource]];
+	ObjectFile *copy = [[ObjectFile alloc] initWithData:[object data]];
+
+	STAssertEquals(copy.wordCount, object.wordCount, nil);
+	STAssertEquals(copy.relocationCount, object.relocationCount, nil);
+	STAssertEquals(copy.symbolCount, object.symbolCount, nil);
+	STAssertEqualObjects([copy data], [object data], nil);
+	STAssertEquals([copy addressOfSymbol:1], 1, nil);
+	STAssertEqualObjects([copy nameOfSymbol:2], @"back", nil);
+}
+
+- (void)testObjectFileInitWithDataCalledWithCorruptCountsThrows
+{
+	NSData *data = [[self objectOfSource:[self librarySource]] data];
+
+	NSMutableData *truncated = [data mutableCopy];
+	uint32_t wordCount = 0xFFFFFFFF;
+	[truncated replaceBytesInRange:NSMakeRange(2 * sizeof(uint32_t), sizeof(wordCount)) withBytes:&wordCount];
+
+	NSMutableData *corrupt = [data mutableCopy];
+	int32_t symbol = 99;
+	[corrupt replaceBytesInRange:NSMakeRange([corrupt length] - sizeof(symbol), sizeof(symbol)) withBytes:&symbol];
+
+	STAssertThrows((void)[[ObjectFile alloc] initWithData:truncated], nil);
+	STAssertThrows((void)[[ObjectFile alloc] initWithData:corrupt], nil);
+}
+
+- (void)testLinkedLibraryLoadsIntoMemoryAtItsBaseAddress
+{
+	Linker *linker = [[Linker alloc] init];
+	[linker addObject:[self objectOfSource:@":lib SET A, 5\n:spin SUB A, 1\nIFN A, 0\nSET PC, spin"]];
+
+	NSData *image = [linker linkAtBaseAddress:0x1000];
+
+	Memory *memory = [[Memory alloc] init];
+	[memory loadWords:[image bytes] count:[image length] / sizeof(uint16_t) atAddress:0x1000];
+
+	STAssertEquals([memory getMemoryValueAtIndex:0x1004], 0x1001, nil);
+}
+
+@end
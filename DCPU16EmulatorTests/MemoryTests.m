@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+#import "MemoryTests.h"
+#import "Memory.h"
+
+@implementation MemoryTests
+
+- (void)testReadLocalityStatsCalledWithTrackingOffReturnsZeros
+{
+	Memory *memory = [[Memory alloc] init];
+
+	[memory setMemoryValue:1 atIndex:0x100];
+	[memory getMemoryValueAtIndex:0x100];
+
+	struct memory_locality_stats stats;
+	[memory readLocalityStats:&stats];
+
+	STAssertFalse(memory.tracksAccesses, nil);
+	STAssertEquals(stats.reads + stats.writes + stats.fetches, (uint64_t)0, nil);
+	STAssertEquals([[memory workingSets] length], (NSUInteger)0, nil);
+}
+
+- (void)testReadLocalityStatsCalledAfterAccessesCountsWordsAndPages
+{
+	Memory *memory = [[Memory alloc] init];
+	memory.tracksAccesses = YES;
+
+	[memory setMemoryValue:1 atIndex:0x100];
+	[memory setMemoryValue:2 atIndex:0x101];
+	[memory getMemoryValueAtIndex:0x100];
+	[memory getMemoryValueAtIndex:0x2000];
+
+	struct memory_locality_stats stats;
+	[memory readLocalityStats:&stats];
+
+	STAssertEquals(stats.reads, (uint64_t)2, nil);
+	STAssertEquals(stats.writes, (uint64_t)2, nil);
+	STAssertEquals(stats.wordsTouched, (uint32_t)3, nil);
+	STAssertEquals(stats.pagesTouched, (uint32_t)2, nil);
+
+	const uint32_t *writes = [[memory wordHeatmapOfKind:MEMORY_ACCESS_WRITE] bytes];
+
+	STAssertEquals(writes[0x101], (uint32_t)1, nil);
+	STAssertEqualObjects([memory pageHeatmapCSV], @"page,reads,writes,fetches\n1,1,2,0\n32,1,0,0\n", nil);
+}
+
+- (void)testReadInstructionAtProgramCounterClosesWorkingSetWindows
+{
+	Memory *memory = [[Memory alloc] init];
+	memory.tracksAccesses = YES;
+	memory.workingSetWindow = 2;
+
+	for(int pc = 0; pc < 5; pc++)
+	{
+		[memory setProgramCounter:pc * MEMORY_PAGE_WORDS];
+		[memory readInstructionAtProgramCounter];
+	}
+
+	struct memory_locality_stats stats;
+	[memory readLocalityStats:&stats];
+
+	STAssertEquals(stats.fetches, (uint64_t)5, nil);
+	STAssertEquals(stats.windows, (uint32_t)2, nil);
+	STAssertEquals(stats.peakWorkingSet, (uint32_t)2, nil);
+}
+
+- (void)testSetStackPointerTracksStackDepthHighWater
+{
+	Memory *memory = [[Memory alloc] init];
+	memory.tracksAccesses = YES;
+
+	[memory setStackPointer:0xFFFF];
+	[memory incrementStackPointer:-1];
+	[memory incrementStackPointer:1];
+	[memory setStackPointer:0];
+
+	struct memory_locality_stats stats;
+	[memory readLocalityStats:&stats];
+
+	STAssertEquals(stats.stackDepthHighWater, (uint32_t)2, nil);
+}
+
+- (void)testLoadWordsCalledWithMoreThanMemorySizeThrows
+{
+	Memory *memory = [[Memory alloc] init];
+	uint16_t *words = calloc(MEMORY_SIZE + 1, sizeof(uint16_t));
+
+	STAssertThrows([memory loadWords:words count:MEMORY_SIZE + 1], nil);
+	STAssertThrows([memory loadWords:words count:1 atAddress:-1], nil);
+	STAssertThrows([memory loadWords:words count:1 atAddress:MEMORY_SIZE], nil);
+
+	free(words);
+}
+
+- (void)testLoadWordsAtAddressWrapsAroundTheEndOfMemory
+{
+	Memory *memory = [[Memory alloc] init];
+	uint16_t words[] = {1, 2};
+
+	[memory loadWords:words count:2 atAddress:MEMORY_SIZE - 1];
+
+	STAssertEquals([memory getMemoryValueAtIndex:MEMORY_SIZE - 1], 1, nil);
+	STAssertEquals([memory getMemoryValueAtIndex:0], 2, nil);
+}
+
+- (void)testSetMemoryValueCalledPastTheEndOfMemoryWraps
+{
+	Memory *memory = [[Memory alloc] init];
+
+	[memory setMemoryValue:7 atIndex:MEMORY_SIZE + 3];
+
+	STAssertEquals([memory getMemoryValueAtIndex:3], 7, nil);
+}
+
+@end
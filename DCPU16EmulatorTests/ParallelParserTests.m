@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+#import "ParallelParserTests.h"
+#import "ParallelParser.h"
+#import "Parser.h"
+#import "Statment.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+#import "OperandFactory.h"
+
+@implementation ParallelParserTests
+
+- (void)testParseCalledWithSmallChunksGeneratesSameStatmentsAsParser
+{
+	NSString *code = @"\n\
+        SET A, 0x30              ; 7c01 0030\n\
+        SET [0x1000], 0x20       ; 7de1 1000 0020\n\
+        SUB A, [0x1000]          ; 7803 1000\n\
+        IFN A, 0x10              ; c00d\n\
+        SET PC, crash            ; 7dc1 001a [*]\n\
+\n\
+        SET I, 10                ; a861\n\
+        SET A, 0x2000            ; 7c01 2000\n\
+:loop\n\
+        SET [0x2000+I], [A]      ; 2161 2000\n\
+        SUB I, 1                 ; 8463\n\
+        IFN I, 0                 ; 806d\n\
+        SET PC, loop             ; 7dc1 000d [*]\n\
+:crash  SET PC, crash            ; 7dc1 001a [*]";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+								  consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	ParallelParser *pp = [[ParallelParser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	pp.linesPerChunk = 2;
+	[pp parseSource:code withLexer:lexer];
+
+	STAssertEquals((int)[pp.statments count], 12, nil);
+	STAssertEquals((int)[pp.statments count], (int)[p.statments count], nil);
+
+	for(NSUInteger i = 0; i < [p.statments count]; i++)
+	{
+		Statment *expected = [p.statments objectAtIndex:i];
+		Statment *actual = [pp.statments objectAtIndex:i];
+
+		STAssertEqualObjects(actual.menemonic, expected.menemonic, nil);
+		STAssertEqualObjects(actual.label, expected.label, nil);
+	}
+}
+
+- (void)testParseCalledWithErrorInLaterChunkReportsSourceLineNumber
+{
+	NSString *code = @"SET A, 1\n\
+SET B, 2\n\
+\n\
+SET C, 3\n\
+FOO X, 4";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	__block NSString *error = nil;
+
+	ParallelParser *pp = [[ParallelParser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	pp.linesPerChunk = 2;
+	pp.didFinishParsingWithError = ^(NSString *message)
+	{
+		error = message;
+	};
+	[pp parseSource:code withLexer:lexer];
+
+	STAssertNotNil(error, nil);
+	STAssertTrue([error rangeOfString:@"line 5:"].location != NSNotFound, error);
+}
+
+- (void)testParseCalledWithBlankAndCommentLinesAfterLabelKeepsLabelWithInstruction
+{
+	NSString *code = @"SET A, 1\n\
+:loop\n\
+\n\
+; the loop body\n\
+SET B, 2\n\
+SET PC, loop";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+								  consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	ParallelParser *pp = [[ParallelParser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	pp.linesPerChunk = 2;
+	[pp parseSource:code withLexer:lexer];
+
+	STAssertEquals((int)[pp.statments count], (int)[p.statments count], nil);
+
+	for(NSUInteger i = 0; i < [p.statments count]; i++)
+	{
+		Statment *expected = [p.statments objectAtIndex:i];
+		Statment *actual = [pp.statments objectAtIndex:i];
+
+		STAssertEqualObjects(actual.menemonic, expected.menemonic, nil);
+		STAssertEqualObjects(actual.label, expected.label, nil);
+	}
+}
+
+@end
@@ -33,6 +33,9 @@
 #import "IgnoreWhiteSpaceTokenStrategy.h"
 #import "ConsumeToken.h"
 #import "OperandFactory.h"
+#import "ParseDiagnostic.h"
+#import "OperandArena.h"
+#import "StatmentTable.h"
 
 @implementation ParserTests
 
@@ -285,5 +288,156 @@
 	STAssertTrue([p.statments count] == 17, nil);
 }
 
+- (void)testParseCalledWithDatStringFollowedByInstructionGeneratesPackedDatAndInstruction
+{
+	NSString *code = @":data DAT \"Hi\", 0\n\
+	SET A, 1";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	STAssertTrue([p.statments count] == 2, nil);
+
+	Statment *s = [p.statments objectAtIndex:0];
+
+	STAssertTrue(s.isData, nil);
+	STAssertEquals((int)[s.dat length], (int)(5 * sizeof(UInt16)), nil);
+	STAssertEquals(((const UInt16 *)[s.dat bytes])[1], (UInt16)'H', nil);
+	STAssertEquals(((const UInt16 *)[s.dat bytes])[4], (UInt16)0, nil);
+
+	s = [p.statments objectAtIndex:1];
+
+	STAssertTrue(s.opcode == OP_SET, nil);
+}
+
+- (void)testParseCalledWithRecoverFromErrorsCollectsAllDiagnosticsAndKeepsValidStatments
+{
+	NSString *code = @"SET A, 1\n\
+FOO B, 2\n\
+SET C, 3\n\
+SET $, 4\n\
+SET X, 5";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	__block NSArray *reported = nil;
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	p.recoverFromErrors = YES;
+	p.didFinishParsingWithDiagnostics = ^(NSArray *diagnostics)
+	{
+		reported = diagnostics;
+	};
+	[p parseSource:code withLexer:lexer];
+
+	STAssertEquals((int)[p.statments count], 3, nil);
+	STAssertEquals((int)[reported count], 2, nil);
+
+	ParseDiagnostic *first = [reported objectAtIndex:0];
+
+	STAssertEquals(first.line, 2, nil);
+	STAssertEquals(first.column, 0, nil);
+	STAssertEquals((int)first.tokenRange.length, 3, nil);
+	STAssertEquals(((ParseDiagnostic *)[reported objectAtIndex:1]).line, 4, nil);
+}
+
+- (void)testParseCalledWithRecoverFromErrorsReportsRangeOfOffendingToken
+{
+	NSString *code = @"SET $, 4\n\
+SET A, ]";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	__block NSArray *reported = nil;
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	p.recoverFromErrors = YES;
+	p.didFinishParsingWithDiagnostics = ^(NSArray *diagnostics)
+	{
+		reported = diagnostics;
+	};
+	[p parseSource:code withLexer:lexer];
+
+	STAssertEquals((int)[reported count], 2, nil);
+
+	ParseDiagnostic *unmatched = [reported objectAtIndex:0];
+
+	STAssertEquals(unmatched.line, 1, nil);
+	STAssertEquals(unmatched.column, 4, nil);
+	STAssertEquals((int)unmatched.tokenRange.location, 4, nil);
+	STAssertEquals((int)unmatched.tokenRange.length, 1, nil);
+
+	ParseDiagnostic *unexpected = [reported objectAtIndex:1];
+
+	STAssertEquals(unexpected.line, 2, nil);
+	STAssertEquals(unexpected.column, 7, nil);
+	STAssertEquals((int)unexpected.tokenRange.location, 7, nil);
+	STAssertEquals((int)unexpected.tokenRange.length, 1, nil);
+}
+
+- (void)testParseCalledWithTableRecyclesOperandArenaAfterEveryStatment
+{
+	NSString *code = @"SET A, 1\n\
+SET [B], 0x30\n\
+SET [0x10+C], PC";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer];
+
+	STAssertEquals((int)p.operandArena.count, 6, nil);
+
+	Statment *s = [p.statments lastObject];
+
+	STAssertTrue([s.firstOperand isKindOfClass:[IndirectNextWordOffsetOperand class]], nil);
+	STAssertTrue(s.firstOperand.nextWord == 0x10, nil);
+	STAssertTrue(s.firstOperand.registerValue == REG_C, nil);
+	STAssertTrue([s.secondOperand isKindOfClass:[ProgramCounterOperand class]], nil);
+
+	lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+								  consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	StatmentTable *table = [[StatmentTable alloc] init];
+	[p parseSource:code withLexer:lexer intoTable:table];
+
+	STAssertEquals((int)table.count, 3, nil);
+	STAssertEquals((int)p.operandArena.count, 0, nil);
+	STAssertEquals((int)[table operandNextWordsForOperand:FIRST_OPERAND][2], 0x10, nil);
+}
+
+
+- (void)testParseCalledWithShouldCancelStopsBetweenStatments
+{
+	NSString *code = @"SET A, 1\nSET B, 2\nSET C, 3";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	__block int checks = 0;
+	__block BOOL finished = NO;
+
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	p.shouldCancel = ^BOOL
+	{
+		return ++checks == 2;
+	};
+	p.didFinishParsingSuccessfully = ^
+	{
+		finished = YES;
+	};
+
+	[p parseSource:code withLexer:lexer];
+
+	STAssertTrue(p.wasCancelled, nil);
+	STAssertFalse(finished, nil);
+	STAssertEquals((int)[p.statments count], 2, nil);
+}
 
 @end
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "PeepholeOptimizerTests.h"
+#import "PeepholeOptimizer.h"
+#import "Assembler.h"
+#import "Statment.h"
+#import "AssemblyTestSupport.h"
+
+@implementation PeepholeOptimizerTests
+
+- (NSData *)imageOfStatments:(NSArray *)statments
+{
+	Assembler *assembler = [[Assembler alloc] init];
+	[assembler assembleStatments:statments];
+
+	return [assembler image];
+}
+
+- (void)testOptimizeStatmentsTurnsMultiplyAndDivideByPowerOfTwoIntoShifts
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *optimized = [optimizer optimizeStatments:[AssemblyTestSupport statmentsOfSource:@"MUL A, 64\nDIV B, 4\nMUL C, 3"]];
+
+	STAssertEqualObjects([self imageOfStatments:optimized], [self imageOfStatments:[AssemblyTestSupport statmentsOfSource:@"SHL A, 6\nSHR B, 2\nMUL C, 3"]], nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_STRENGTH_REDUCTION].applications, (NSUInteger)2, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_STRENGTH_REDUCTION].cycles, (NSUInteger)2, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_STRENGTH_REDUCTION].words, (NSUInteger)1, nil);
+}
+
+- (void)testOptimizeStatmentsRemovesNoOpsOutsideConditionalsAndKeepsTheirLabels
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *optimized = [optimizer optimizeStatments:[AssemblyTestSupport statmentsOfSource:@":start SET A, A\nSET B, 1\nIFE A, B\nSET C, C\nBOR X, 0"]];
+
+	STAssertEquals((int)[optimized count], 3, nil);
+	STAssertEqualObjects([[optimized objectAtIndex:0] label], @":start", nil);
+	STAssertEqualObjects([[optimized objectAtIndex:0] menemonic], @"SET", nil);
+	STAssertEqualObjects([[optimized objectAtIndex:2] menemonic], @"SET", nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_NO_OP_REMOVAL].applications, (NSUInteger)2, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_NO_OP_REMOVAL].cycles, (NSUInteger)2, nil);
+}
+
+- (void)testOptimizeStatmentsThreadsJumpsThroughChainsOfJumps
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *optimized = [optimizer optimizeStatments:[AssemblyTestSupport statmentsOfSource:@"SET PC, a\n:a SET PC, b\n:b SET PC, c\n:c SET A, 1"]];
+
+	STAssertEqualObjects([[[optimized objectAtIndex:0] secondOperand] label], @"c", nil);
+	STAssertEqualObjects([[[optimized objectAtIndex:1] secondOperand] label], @"c", nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_JUMP_THREADING].applications, (NSUInteger)2, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_JUMP_THREADING].cycles, (NSUInteger)6, nil);
+	STAssertEquals([optimizer totalCyclesSaved], (NSUInteger)6, nil);
+}
+
+- (void)testOptimizeStatmentsCalledWithJumpCycleTerminates
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *optimized = [optimizer optimizeStatments:[AssemblyTestSupport statmentsOfSource:@":a SET PC, b\n:b SET PC, a"]];
+
+	STAssertEquals((int)[optimized count], 2, nil);
+}
+
+- (void)testOptimizeStatmentsRemovesUnlabelledCodeAfterUnconditionalJump
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *source = [AssemblyTestSupport statmentsOfSource:@"SET PC, end\nSET A, 1\nSET B, 0x40\n:end SET C, 3\nSET PC, POP\nDAT 1"];
+	NSArray *optimized = [optimizer optimizeStatments:source];
+
+	STAssertEquals((int)[source count], 6, nil);
+	STAssertEquals((int)[optimized count], 4, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_UNREACHABLE_CODE].words, (NSUInteger)3, nil);
+	STAssertTrue([[optimizer report] rangeOfString:@"unreachable code: 2 applied"].location != NSNotFound, nil);
+}
+
+- (void)testOptimizeStatmentsCountsShortIndirectOperandsAsTheAssemblerEncodesThem
+{
+	PeepholeOptimizer *optimizer = [[PeepholeOptimizer alloc] init];
+	NSArray *statments = [AssemblyTestSupport statmentsOfSource:@"BOR [0x10], 0\nBOR [0x1000], 0\nXOR [0x8+A], 0"];
+	NSArray *optimized = [optimizer optimizeStatments:statments];
+
+	STAssertEquals((int)[optimized count], 0, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_NO_OP_REMOVAL].words, [[self imageOfStatments:statments] length] / sizeof(uint16_t), nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_NO_OP_REMOVAL].words, (NSUInteger)4, nil);
+	STAssertEquals([optimizer savingsForRule:PEEPHOLE_NO_OP_REMOVAL].cycles, (NSUInteger)4, nil);
+}
+
+@end
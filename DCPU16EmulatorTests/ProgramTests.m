@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+
+#import "ProgramTests.h"
+#import "Program.h"
+
+@interface ProgramTests ()
+
+@property(nonatomic, assign) int possibleNextInputCalls;
+@property(nonatomic, assign) int currentInstructionCalls;
+@property(nonatomic, assign) int instructionSetCalls;
+@property(nonatomic, strong) NSArray *possibleNextInput;
+@property(nonatomic, strong) Instruction *currentInstruction;
+
+@end
+
+@implementation ProgramTests
+
+@synthesize possibleNextInputCalls;
+@synthesize currentInstructionCalls;
+@synthesize instructionSetCalls;
+@synthesize possibleNextInput;
+@synthesize currentInstruction;
+
+- (void)program:(Program *)program didChangePossibleNextInput:(NSArray *)input
+{
+	self.possibleNextInputCalls++;
+	self.possibleNextInput = input;
+}
+
+- (void)program:(Program *)program didChangeCurrentInstruction:(Instruction *)instruction
+{
+	self.currentInstructionCalls++;
+	self.currentInstruction = instruction;
+}
+
+- (void)program:(Program *)program didChangeInstructionSet:(NSArray *)instructionSet
+{
+	self.instructionSetCalls++;
+}
+
+- (void)testEditsAreCoalescedIntoOneCallPerChange
+{
+	Program *program = [[Program alloc] init];
+	program.delegate = self;
+
+	[program assignLabelToCurrentInstruction:@":start"];
+	[program assignValueToCurrentInstruction:@"SET"];
+	[program assignValueToCurrentInstruction:@"A"];
+	[program assignValueToCurrentInstruction:@"0x30"];
+
+	STAssertEquals(self.currentInstructionCalls, 0, nil);
+
+	[program flushChanges];
+
+	STAssertEquals(self.possibleNextInputCalls, 1, nil);
+	STAssertEquals(self.currentInstructionCalls, 1, nil);
+	STAssertEquals(self.instructionSetCalls, 1, nil);
+	STAssertTrue(self.currentInstruction.state == Complete, nil);
+	STAssertEqualObjects(self.currentInstruction.operand2, @"0x30", nil);
+
+	[program flushChanges];
+
+	STAssertEquals(self.currentInstructionCalls, 1, nil);
+}
+
+- (void)testEditsAreDeliveredOnTheNextRunLoopTurn
+{
+	Program *program = [[Program alloc] init];
+	program.delegate = self;
+
+	[program assignValueToCurrentInstruction:@"SET"];
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+
+	STAssertEquals(self.currentInstructionCalls, 1, nil);
+	STAssertEqualObjects(self.currentInstruction.opcode, @"SET", nil);
+}
+
+- (void)testPossibleNextInputIsSharedBetweenInstructionsInTheSameState
+{
+	Instruction *first = [[Instruction alloc] init];
+	Instruction *second = [[Instruction alloc] init];
+
+	STAssertTrue([first possibleNextInput] == [second possibleNextInput], nil);
+	STAssertEqualObjects([[first possibleNextInput] objectAtIndex:0], @"Label", nil);
+
+	[first assignValue:@"SET"];
+
+	STAssertTrue([[first possibleNextInput] containsObject:@"PEEK"], nil);
+	STAssertFalse([[first possibleNextInput] containsObject:@"Label"], nil);
+}
+
+@end
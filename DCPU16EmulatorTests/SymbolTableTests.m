@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2012 Pedro Santos @pedromsantos
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in 
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE.
+ */
+
+
+#import "SymbolTableTests.h"
+#import "SymbolTable.h"
+#import "StatmentTable.h"
+#import "Parser.h"
+#import "Lexer.h"
+#import "IgnoreWhiteSpaceTokenStrategy.h"
+#import "ConsumeToken.h"
+#import "OperandFactory.h"
+
+@implementation SymbolTableTests
+
+- (void)testSymbolForNameCalledTwiceReturnsSameDenseId
+{
+	SymbolTable *symbols = [[SymbolTable alloc] init];
+
+	STAssertEquals([symbols symbolForName:@"loop"], 0, nil);
+	STAssertEquals([symbols symbolForName:@"end"], 1, nil);
+	STAssertEquals([symbols symbolForName:@":loop" fromIndex:1], 0, nil);
+	STAssertEquals([symbols lookupName:@"missing"], NO_SYMBOL, nil);
+	STAssertEquals((int)symbols.count, 2, nil);
+	STAssertEqualObjects([symbols nameForSymbol:1], @"end", nil);
+}
+
+- (void)testSymbolForNameKeepsIdsStableWhenGrowing
+{
+	SymbolTable *symbols = [[SymbolTable alloc] init];
+
+	for(int i = 0; i < 1000; i++)
+	{
+		STAssertEquals([symbols symbolForName:[NSString stringWithFormat:@"label%d", i]], i, nil);
+	}
+
+	STAssertEquals([symbols lookupName:@"label0"], 0, nil);
+	STAssertEquals([symbols lookupName:@"label999"], 999, nil);
+}
+
+- (void)testParseIntoTableRecordsDefinitionLineOfLabels
+{
+	NSString *code = @"SET PC, end\n\
+\n\
+:end SET A, 1";
+
+	Lexer *lexer = [[Lexer alloc] initWithIgnoreTokenStrategy:[[IgnoreWhiteSpaceTokenStrategy alloc] init]
+														 consumeTokenStrategy:[[ConsumeToken alloc] init]];
+
+	StatmentTable *table = [[StatmentTable alloc] init];
+	Parser *p = [[Parser alloc] initWithOperandFactory:[[OperandFactory alloc] init]];
+	[p parseSource:code withLexer:lexer intoTable:table];
+
+	int symbol = [table.symbols lookupName:@"end"];
+
+	STAssertEquals(symbol, 0, nil);
+	STAssertEquals([table.symbols definitionLineForSymbol:symbol], 3, nil);
+	STAssertEquals(table.labels[1], symbol, nil);
+}
+
+@end